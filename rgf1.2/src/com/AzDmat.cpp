@@ -169,20 +169,20 @@ void AzDmat::_transpose(AzDmat *m_out,
 }
 
 /*-------------------------------------------------------------*/
-void AzDmat::transpose_from(const AzSmat *m_inp)
+void AzDmat::transpose_from(const AzSmat *m_inp, 
+                            AzThreads *threads)
 {
+  const char *eyec = "AzDmat::transpose_from"; 
   reform(m_inp->colNum(), m_inp->rowNum()); 
-  int cx; 
-  for (cx = 0; cx < m_inp->colNum(); ++cx) {
-    const AzSvect *v_inp = m_inp->col(cx); 
-    AzCursor cursor; 
-    for ( ; ; ) {
-      double val; 
-      int rx = v_inp->next(cursor, val); 
-      if (rx < 0) break; 
-      set(cx, rx, val); 
-    }
+  if (col_num <= 0 || row_num <= 0) return; 
+  AzBaseArray<double *> _dense; 
+  double **dense = NULL; 
+  _dense.alloc(&dense, col_num, eyec, "dense"); 
+  int col; 
+  for (col = 0; col < col_num; ++col) {
+    dense[col] = column[col]->point_u(); 
   }
+  m_inp->_transpose_dense(dense, threads); 
 }
 
 /*-------------------------------------------------------------*/
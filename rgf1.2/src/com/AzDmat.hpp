@@ -373,6 +373,54 @@ protected:
   }
 }; 
 
+//! single-precision copy of a dense vector, for gathering with less memory traffic
+class AzFvect {
+protected:
+  int num; 
+  float *elm; /* updated only through AzBaseArray functions */
+  AzBaseArray<float> a; 
+
+public:
+  AzFvect() : num(0), elm(NULL) {}
+  AzFvect(const AzDvect *inp) : num(0), elm(NULL) {
+    set(inp); 
+  }
+  void set(const AzDvect *inp) {
+    const double *inp_elm = inp->point(); 
+    _reform(inp->rowNum()); 
+    int ex; 
+    for (ex = 0; ex < num; ++ex) elm[ex] = (float)inp_elm[ex]; 
+  }
+  void set(const AzFvect *inp) {
+    _reform(inp->num); 
+    int ex; 
+    for (ex = 0; ex < num; ++ex) elm[ex] = inp->elm[ex]; 
+  }
+  inline void reset() {
+    a.free(&elm); num = 0; 
+  }
+  inline int rowNum() const { return num; }
+  inline const float *point() const { return elm; }
+  inline float *point_u() { return elm; }
+  static inline bool isNull(const AzFvect *v) {
+    if (v == NULL) return true; 
+    if (v->num == 0) return true; 
+    return false; 
+  }
+
+protected:
+  inline void _reform(int new_num) {
+    if (new_num == num) return; 
+    a.free(&elm); num = 0; 
+    a.alloc(&elm, new_num, "AzFvect::_reform"); 
+    num = new_num; 
+  }
+
+private:
+  AzFvect(const AzFvect &) {} /* not supported */
+  AzFvect & operator =(const AzFvect &) { return *this; }
+}; 
+
 //! dense matrix 
 class AzDmat : /* implements */ public virtual AzReadOnlyMatrix {
 protected:
@@ -494,7 +542,7 @@ public:
   void transpose_to(AzDmat *m_out, int col_begin = -1, int col_end = -1) const { 
     transpose(m_out, col_begin, col_end); 
   }
-  void transpose_from(const AzSmat *m_inp); 
+  void transpose_from(const AzSmat *m_inp, AzThreads *threads=NULL); /* threads may be NULL */
 
   void cut(double min_val); 
 
@@ -18,6 +18,11 @@
 
 #include "AzLoss.hpp"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define _AZ_LOSS_SIMD_
+#include <immintrin.h>
+#endif
+
 /*--------------------------------------------------------*/
 double AzLoss::getLoss(AzLossType loss_type, 
                        double p, double y, 
@@ -136,13 +141,14 @@ AzLosses AzLoss::getLosses(AzLossType loss_type,
 /* 
  * This is for speeding up AzOptOntTree.  It's the same as calling 
  * getLosses from the loop but faster especially for square loss. 
- *
+ * T: double, or float with single precision; the sums are in double. 
  */
-void AzLoss::sum_deriv(AzLossType loss_type, 
+template <class T>
+static void _sum_deriv(AzLossType loss_type, 
                        const int *dxs, 
                        int dx_num, 
-                       const double *p, 
-                       const double *y, 
+                       const T *p, 
+                       const T *y, 
                        double py_avg, 
                        /*---  output  ---*/
                        double &nega_dL, 
@@ -159,14 +165,14 @@ void AzLoss::sum_deriv(AzLossType loss_type,
     int ix; 
     for (ix = 0; ix < dx_num; ++ix) {
       int dx = dxs[ix]; 
-      nega_dL += (y[dx]-p[dx]); 
+      nega_dL += ((double)y[dx]-p[dx]); 
     }
   }
   else if (loss_type == AzLoss_Expo) {
     int ix; 
     for (ix = 0; ix < dx_num; ++ix) {
       int dx = dxs[ix];       
-      double py = p[dx]*y[dx]; 
+      double py = (double)p[dx]*y[dx]; 
       py -= py_avg; /* for numerical stability */
       double ee = my_exp(-py); 
       ddL += ee;            /* exp(-py)*y*y */
@@ -177,7 +183,7 @@ void AzLoss::sum_deriv(AzLossType loss_type,
     int ix; 
     for (ix = 0; ix < dx_num; ++ix) {
       int dx = dxs[ix]; 
-      AzLosses o = getLosses(loss_type, p[dx], y[dx], py_avg); 
+      AzLosses o = AzLoss::getLosses(loss_type, p[dx], y[dx], py_avg); 
       ddL += o.loss2; 
       nega_dL += o._loss1; 
     }
@@ -186,17 +192,13 @@ void AzLoss::sum_deriv(AzLossType loss_type,
 }
 
 /*------------------------------------------------------------------*/
-/* 
- * This is for speeding up AzOptOntTree.  It's the same as calling 
- * getLosses from the loop but faster especially for square loss. 
- *
- */
-void AzLoss::sum_deriv_weighted(AzLossType loss_type, 
+template <class T>
+static void _sum_deriv_weighted(AzLossType loss_type, 
                        const int *dxs, 
                        int dx_num, 
-                       const double *p, 
-                       const double *y, 
-                       const double *dw, 
+                       const T *p, 
+                       const T *y, 
+                       const T *dw, 
                        double py_avg, 
                        /*---  output  ---*/
                        double &nega_dL, 
@@ -212,7 +214,7 @@ void AzLoss::sum_deriv_weighted(AzLossType loss_type,
     int ix; 
     for (ix = 0; ix < dx_num; ++ix) {
       int dx = dxs[ix]; 
-      nega_dL += dw[dx]*(y[dx]-p[dx]); 
+      nega_dL += (double)dw[dx]*((double)y[dx]-p[dx]); 
       ddL += dw[dx]; 
     }
   }
@@ -220,18 +222,18 @@ void AzLoss::sum_deriv_weighted(AzLossType loss_type,
     int ix; 
     for (ix = 0; ix < dx_num; ++ix) {
       int dx = dxs[ix];       
-      double py = p[dx]*y[dx]; 
+      double py = (double)p[dx]*y[dx]; 
       py -= py_avg; /* for numerical stability */
       double ee = my_exp(-py); 
       ddL += (dw[dx]*ee);            /* exp(-py)*y*y */
-      nega_dL += (dw[dx]*y[dx]*ee);  /* exp(-py)*y */
+      nega_dL += ((double)dw[dx]*y[dx]*ee);  /* exp(-py)*y */
     }
   }
   else {
     int ix; 
     for (ix = 0; ix < dx_num; ++ix) {
       int dx = dxs[ix]; 
-      AzLosses o = getLosses(loss_type, p[dx], y[dx], py_avg); 
+      AzLosses o = AzLoss::getLosses(loss_type, p[dx], y[dx], py_avg); 
       ddL += (dw[dx]*o.loss2); 
       nega_dL += (dw[dx]*o._loss1); 
     }
@@ -239,6 +241,51 @@ void AzLoss::sum_deriv_weighted(AzLossType loss_type,
   }
 }
 
+/*------------------------------------------------------------------*/
+void AzLoss::sum_deriv(AzLossType loss_type, 
+                       const int *dxs, 
+                       int dx_num, 
+                       const double *p, 
+                       const double *y, 
+                       double py_avg, 
+                       /*---  output  ---*/
+                       double &nega_dL, 
+                       double &ddL) 
+{
+  _sum_deriv(loss_type, dxs, dx_num, p, y, py_avg, nega_dL, ddL); 
+}
+
+/*------------------------------------------------------------------*/
+void AzLoss::sum_deriv_weighted(AzLossType loss_type, 
+                       const int *dxs, 
+                       int dx_num, 
+                       const double *p, 
+                       const double *y, 
+                       const double *dw, 
+                       double py_avg, 
+                       /*---  output  ---*/
+                       double &nega_dL, 
+                       double &ddL) 
+{
+  _sum_deriv_weighted(loss_type, dxs, dx_num, p, y, dw, py_avg, nega_dL, ddL); 
+}
+
+/*------------------------------------------------------------------*/
+void AzLoss::sum_deriv(AzLossType loss_type, 
+                       const int *dxs, 
+                       int dx_num, 
+                       const float *p, 
+                       const float *y, 
+                       const float *dw, /* may be NULL */
+                       double py_avg, 
+                       /*---  output  ---*/
+                       double &nega_dL, 
+                       double &ddL) 
+{
+  if (dw == NULL) _sum_deriv(loss_type, dxs, dx_num, p, y, py_avg, nega_dL, ddL); 
+  else            _sum_deriv_weighted(loss_type, dxs, dx_num, p, y, dw, py_avg, nega_dL, ddL); 
+}
+
 /*------------------------------------------------------------------*/
 void AzLoss::help_lines(int level, AzDataPool<AzBytArr> *pool_desc) {
   AzIntArr ia_l_type; 
@@ -367,3 +414,156 @@ double AzLoss::negativeDeriv12(AzLossType loss_type,
   }
   return lam_scale; 
 }
+
+#ifdef _AZ_LOSS_SIMD_
+/*------------------------------------------------------------------*/
+/* exp(x) for x in [-500,500] (as my_exp) by x = n*log(2) + r,      */
+/* |r| <= log(2)/2, and Taylor expansion of exp(r) to r^13           */
+__attribute__((target("avx2,fma")))
+static inline __m256d exp4_avx2(__m256d x)
+{
+  x = _mm256_min_pd(_mm256_set1_pd(500), _mm256_max_pd(_mm256_set1_pd(-500), x)); 
+  __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634074)), 
+                              _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); 
+  /*---  Cody-Waite: log(2) = hi + lo, n*hi is exact  ---*/
+  __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(6.93145751953125E-1), x); 
+  r = _mm256_fnmadd_pd(n, _mm256_set1_pd(1.42860682030941723212E-6), r); 
+
+  static const double coeff[] = { /* 1/k!, k=13,12,...,0 */
+    1.0/6227020800.0, 1.0/479001600.0, 1.0/39916800.0, 1.0/3628800.0, 
+    1.0/362880.0, 1.0/40320.0, 1.0/5040.0, 1.0/720.0, 1.0/120.0, 1.0/24.0, 
+    1.0/6.0, 0.5, 1.0, 1.0, 
+  }; 
+  __m256d e = _mm256_set1_pd(coeff[0]); 
+  int kx; 
+  for (kx = 1; kx < (int)(sizeof(coeff)/sizeof(coeff[0])); ++kx) {
+    e = _mm256_fmadd_pd(e, r, _mm256_set1_pd(coeff[kx])); 
+  }
+
+  /*---  times 2^n  ---*/
+  __m256i n64 = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n)); 
+  __m256i bits = _mm256_slli_epi64(_mm256_add_epi64(n64, _mm256_set1_epi64x(1023)), 52); 
+  return _mm256_mul_pd(e, _mm256_castsi256_pd(bits)); 
+}
+
+/*------------------------------------------------------------------*/
+__attribute__((target("avx2,fma")))
+static void sum_deriv_avx2(AzLossType loss_type, 
+                           const int *dxs, 
+                           int dx_num, 
+                           const double *p, 
+                           const double *y, 
+                           const double *dw, /* may be NULL */
+                           double py_avg, 
+                           /*---  output  ---*/
+                           double &nega_dL, 
+                           double &ddL)
+{
+  const __m256d one = _mm256_set1_pd(1); 
+  __m256d sum1 = _mm256_setzero_pd(), sum2 = _mm256_setzero_pd(); 
+  int ix; 
+  for (ix = 0; ix+4 <= dx_num; ix += 4) {
+    __m128i idx = _mm_loadu_si128((const __m128i *)(dxs+ix)); 
+    __m256d pv = _mm256_i32gather_pd(p, idx, 8); 
+    __m256d yv = _mm256_i32gather_pd(y, idx, 8); 
+    __m256d a, b; /* -L', L'' */
+    if (loss_type == AzLoss_Expo) {
+      __m256d ee = exp4_avx2(_mm256_fnmadd_pd(pv, yv, _mm256_set1_pd(py_avg))); 
+      a = _mm256_mul_pd(yv, ee); 
+      b = ee; 
+    }
+    else if (loss_type == AzLoss_Logistic1) {
+      __m256d ee = exp4_avx2(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_mul_pd(pv, yv))); 
+      __m256d ee1 = _mm256_add_pd(one, ee); 
+      __m256d t = _mm256_div_pd(_mm256_mul_pd(yv, ee), ee1); 
+      a = t; 
+      b = _mm256_div_pd(_mm256_mul_pd(yv, t), ee1); 
+    }
+    else if (loss_type == AzLoss_LogRe) {
+      __m256d ee = exp4_avx2(_mm256_sub_pd(_mm256_setzero_pd(), pv)); 
+      __m256d q = _mm256_div_pd(one, _mm256_add_pd(one, ee)); 
+      a = _mm256_sub_pd(yv, q); 
+      b = _mm256_mul_pd(q, _mm256_sub_pd(one, q)); 
+    }
+    else { /* LS */
+      a = _mm256_sub_pd(yv, pv); 
+      b = one; 
+    }
+    if (dw != NULL) {
+      __m256d wv = _mm256_i32gather_pd(dw, idx, 8); 
+      a = _mm256_mul_pd(wv, a); 
+      b = _mm256_mul_pd(wv, b); 
+    }
+    sum1 = _mm256_add_pd(sum1, a); 
+    sum2 = _mm256_add_pd(sum2, b); 
+  }
+  double s1[4], s2[4]; 
+  _mm256_storeu_pd(s1, sum1); 
+  _mm256_storeu_pd(s2, sum2); 
+  nega_dL = (s1[0]+s1[1]) + (s1[2]+s1[3]); 
+  ddL = (s2[0]+s2[1]) + (s2[2]+s2[3]); 
+
+  /*---  the rest  ---*/
+  for ( ; ix < dx_num; ++ix) {
+    int dx = dxs[ix]; 
+    double a, b; 
+    if (loss_type == AzLoss_Expo) {
+      double ee = my_exp(py_avg - p[dx]*y[dx]); 
+      a = y[dx]*ee; 
+      b = ee; 
+    }
+    else if (loss_type == AzLoss_Square || loss_type == AzLoss_LS) {
+      a = y[dx]-p[dx]; 
+      b = 1; 
+    }
+    else {
+      AzLosses o = AzLoss::getLosses(loss_type, p[dx], y[dx], py_avg); 
+      a = o._loss1; 
+      b = o.loss2; 
+    }
+    if (dw != NULL) {
+      a *= dw[dx]; 
+      b *= dw[dx]; 
+    }
+    nega_dL += a; 
+    ddL += b; 
+  }
+}
+#endif
+
+/*------------------------------------------------------------------*/
+bool AzLoss::canVect(AzLossType loss_type)
+{
+#ifdef _AZ_LOSS_SIMD_
+  static bool hasAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); 
+  if (!hasAVX2) return false; 
+  if (loss_type == AzLoss_Square || loss_type == AzLoss_LS || 
+      loss_type == AzLoss_Expo || loss_type == AzLoss_Logistic1 || 
+      loss_type == AzLoss_LogRe) {
+    return true; 
+  }
+#endif
+  return false; 
+}
+
+/*------------------------------------------------------------------*/
+void AzLoss::sum_deriv_vect(AzLossType loss_type, 
+                       const int *dxs, 
+                       int dx_num, 
+                       const double *p, 
+                       const double *y, 
+                       const double *dw, /* may be NULL */
+                       double py_avg, 
+                       /*---  output  ---*/
+                       double &nega_dL, 
+                       double &ddL) 
+{
+#ifdef _AZ_LOSS_SIMD_
+  if (canVect(loss_type)) {
+    sum_deriv_avx2(loss_type, dxs, dx_num, p, y, dw, py_avg, nega_dL, ddL); 
+    return; 
+  }
+#endif
+  if (dw == NULL) sum_deriv(loss_type, dxs, dx_num, p, y, py_avg, nega_dL, ddL); 
+  else            sum_deriv_weighted(loss_type, dxs, dx_num, p, y, dw, py_avg, nega_dL, ddL); 
+}
@@ -118,6 +118,34 @@ public:
                        double &nega_dL, 
                        double &ddL); 
 
+  /*---  single precision (precision=single); dw may be NULL  ---*/
+  static void sum_deriv(AzLossType loss_type, 
+                       const int *dxs, 
+                       int dx_num, 
+                       const float *p, 
+                       const float *y, 
+                       const float *dw, 
+                       double py_avg, 
+                       /*---  output  ---*/
+                       double &nega_dL, 
+                       double &ddL); 
+
+  /*---  Same as sum_deriv|sum_deriv_weighted, but with AVX2 if the CPU  ---*/
+  /*---  has it and the loss is LS, Expo, Log, or LogRe.  The sum is    ---*/
+  /*---  in a different order and exp is computed by a polynomial       ---*/
+  /*---  (within a few ulp), so the result may differ in the last bits. ---*/
+  static void sum_deriv_vect(AzLossType loss_type, 
+                       const int *dxs, 
+                       int dx_num, 
+                       const double *p, 
+                       const double *y, 
+                       const double *dw, /* may be NULL */
+                       double py_avg, 
+                       /*---  output  ---*/
+                       double &nega_dL, 
+                       double &ddL); 
+  static bool canVect(AzLossType loss_type); 
+
   static AzLosses getLosses(AzLossType loss_type, 
                             double p, double y, 
                             double py_adjust=0); 
@@ -0,0 +1,85 @@
+/* * * * *
+ *  AzMappedFile.cpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#include "AzMappedFile.hpp"
+
+#if !defined(_WIN32)
+#define _AZ_MMAP_
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*--------------------------------------------------------*/
+void AzMappedFile::open(const char *fn)
+{
+  const char *eyec = "AzMappedFile::open"; 
+  close(); 
+  s_fn.reset(fn); 
+
+#ifdef _AZ_MMAP_
+  int fd = ::open(fn, O_RDONLY); 
+  if (fd < 0) {
+    throw new AzException(AzFileIOError, eyec, "Failed to open:", fn); 
+  }
+  struct stat st; 
+  if (fstat(fd, &st) != 0) {
+    ::close(fd); 
+    throw new AzException(AzFileIOError, eyec, "Failed to get the size:", fn); 
+  }
+  len = (AZint8)st.st_size; 
+  if (len > 0) {
+    void *addr = mmap(NULL, (size_t)len, PROT_READ, MAP_SHARED, fd, 0); 
+    if (addr != MAP_FAILED) {
+      map_addr = addr; 
+      data = (const AzByte *)addr; 
+    }
+  }
+  ::close(fd); /* the mapping stays */
+  if (map_addr != NULL || len == 0) {
+    return; 
+  }
+#endif
+
+  /*---  not mapped; read it  ---*/
+  AzFile file(fn); 
+  file.open("rb"); 
+  len = file.size(); 
+  a_buff.alloc(&buff, len/(AZint8)sizeof(double)+1, eyec, "buff"); 
+  if (len > 0) {
+    file.seekReadBytes(0, len, buff); 
+  }
+  file.close(); 
+  data = (const AzByte *)buff; 
+}
+
+/*--------------------------------------------------------*/
+void AzMappedFile::close()
+{
+#ifdef _AZ_MMAP_
+  if (map_addr != NULL) {
+    munmap(map_addr, (size_t)len); 
+  }
+#endif
+  map_addr = NULL; 
+  a_buff.free(&buff); 
+  data = NULL; 
+  len = 0; 
+  s_fn.reset(); 
+}
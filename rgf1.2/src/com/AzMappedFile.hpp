@@ -0,0 +1,59 @@
+/* * * * *
+ *  AzMappedFile.hpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#ifndef _AZ_MAPPED_FILE_HPP_
+#define _AZ_MAPPED_FILE_HPP_
+
+#include "AzUtil.hpp"
+
+//! Read-only view of a whole file.
+/**
+  *  The file is mapped to memory with mmap where available, so that the
+  *  pages are read only when touched and are shared by the processes
+  *  that map the same file.  Elsewhere (e.g., Windows), the file is read
+  *  into a buffer.  Either way, the contents start at an address aligned
+  *  to at least 8 bytes.
+ **/
+class AzMappedFile {
+protected:
+  const AzByte *data; 
+  AZint8 len; 
+  void *map_addr; /* NULL if not mapped */
+  AzBaseArray<double,AZint8> a_buff; /* when not mapped; double for alignment */
+  double *buff; 
+  AzBytArr s_fn; 
+
+public:
+  AzMappedFile() : data(NULL), len(0), map_addr(NULL), buff(NULL) {}
+  ~AzMappedFile() {
+    close(); 
+  }
+  void open(const char *fn); 
+  void close(); 
+
+  inline const AzByte *point() const { return data; }
+  inline AZint8 size() const { return len; }
+  inline bool isMapped() const { return (map_addr != NULL); }
+  inline const char *pointFileName() const { return s_fn.c_str(); }
+
+  AzMappedFile & operator =(const AzMappedFile &inp) {
+    if (this == &inp) return *this; 
+    throw new AzException("AzMappedFile =", "copying AzMappedFile is prohibited"); 
+  }
+}; 
+#endif
@@ -31,6 +31,7 @@
 /* AzBaseArray    Yes     anything that can be copied by "="   */
 /* AzObjArray     Yes     objects; realloc uses "transfer_from */
 /* AzObjPtrArray  Yes     ptr to object                        */
+/* AzObjPool      Yes     ptr to object to be recycled         */
 /*--------------------------------------------------------------*/
 
 /*-----------------------------------------------------*/
@@ -248,6 +249,51 @@ protected:
   }
 };
 
+/*-----------------------------------------------------*/
+/* Objects to be recycled instead of deleted.          */
+/* The pool owns only the idle ones; get() passes the  */
+/* ownership to the caller, and put() takes it back.   */
+/* Objects are not reset; the caller should.           */
+/*-----------------------------------------------------*/
+template<class T, class Int=int>
+class AzObjPool
+{
+protected:
+  T **idle; 
+  AzObjPtrArray<T,Int> a_idle; 
+  Int idle_num; 
+
+public:
+  AzObjPool() : idle(NULL), idle_num(0) {}
+  inline T *get() {
+    if (idle_num > 0) {
+      --idle_num; 
+      T *obj = idle[idle_num]; 
+      idle[idle_num] = NULL; 
+      return obj; 
+    }
+    T *obj = NULL; 
+    try {
+      obj = new T(); 
+    }
+    catch (std::bad_alloc &ba) {
+      throw new AzException(AzAllocError, "AzObjPool::get", ba.what()); 
+    }
+    return obj; 
+  }
+  inline void put(T *obj) { /* NULL is ignored */
+    if (obj == NULL) return; 
+    if (idle_num >= a_idle.size()) {
+      a_idle.realloc(&idle, myMAX(idle_num*2, 64), "AzObjPool::put", "idle"); 
+    }
+    idle[idle_num++] = obj; 
+  }
+  inline Int idleNum() const { return idle_num; }
+  inline void reset() {
+    a_idle.free(&idle); idle_num = 0; 
+  }
+}; 
+
 /*-----------------------------------------------------*/
 template<class T, class Int=int>
 class AzBaseArray  /* expandable array of base type that can be copied by memcpy */
@@ -20,6 +20,7 @@
 #include "AzUtil.hpp"
 #include "AzSmat.hpp"
 #include "AzPrint.hpp"
+#include "AzThreads.hpp"
 
 #define AzVectSmall 32
 
@@ -51,14 +52,69 @@ void AzSmat::initialize(const AzSmat *inp)
   if (inp == NULL) {
     throw new AzException("AzSmat::initialize(AzSmat*)", "null input"); 
   }
-  bool asDense = false; 
-  initialize(inp->row_num, inp->col_num, asDense); 
-  if (inp->column != NULL) {
-    int cx;
-    for (cx = 0; cx < this->col_num; ++cx) {
-      if (inp->column[cx] != NULL) {
-        column[cx] = new AzSvect(inp->column[cx]); 
-      }
+  _set_packed(inp); 
+}
+
+/*-------------------------------------------------------------*/
+AZI_VECT_ELM *AzSmat::reform_packed(int inp_row_num, int inp_col_num, 
+                                    const AZint8 *col_offs)
+{
+  const char *eyec = "AzSmat::reform_packed"; 
+  reform(inp_row_num, inp_col_num); 
+  if (col_num <= 0) {
+    return NULL; 
+  }
+  if (col_offs == NULL || col_offs[0] != 0) {
+    throw new AzException(eyec, "column offsets must start with 0"); 
+  }
+  a_pelm.alloc(&pelm, col_offs[col_num], eyec, "pelm"); 
+  a_pcol.alloc(&pcol, col_num, eyec, "pcol"); 
+  int cx; 
+  for (cx = 0; cx < col_num; ++cx) {
+    AZint8 num = col_offs[cx+1] - col_offs[cx]; 
+    if (num < 0 || num > row_num) {
+      throw new AzException(eyec, "invalid column offsets"); 
+    }
+    if (num == 0) continue; 
+    AzSvect *v = &pcol[cx]; 
+    v->row_num = row_num; 
+    v->elm = pelm + col_offs[cx]; 
+    v->elm_num = (int)num; 
+    v->isView = true; 
+    column[cx] = v; 
+  }
+  return pelm; 
+}
+
+/*-------------------------------------------------------------*/
+/* copy the nonzero components of inp into packed storage      */
+/*-------------------------------------------------------------*/
+void AzSmat::_set_packed(const AzSmat *inp, 
+                         const int *cols, int cnum) /* new2old; negative: zero */
+{
+  int c_num = (cols == NULL) ? inp->col_num : cnum; 
+  AzBaseArray<AZint8> _offs; 
+  AZint8 *offs = NULL; 
+  _offs.alloc(&offs, c_num+1, "AzSmat::_set_packed", "offs"); 
+  offs[0] = 0; 
+  int cx; 
+  for (cx = 0; cx < c_num; ++cx) {
+    int inp_cx = (cols == NULL) ? cx : cols[cx]; 
+    offs[cx+1] = offs[cx] + ((inp_cx < 0) ? 0 : inp->col(inp_cx)->nonZeroRowNum()); 
+  }
+  AZI_VECT_ELM *out = reform_packed(inp->row_num, c_num, offs); 
+  for (cx = 0; cx < col_num; ++cx) {
+    int inp_cx = (cols == NULL) ? cx : cols[cx]; 
+    if (inp_cx < 0) continue; 
+    AZI_VECT_ELM *out_elm = out + offs[cx]; 
+    AzCursor cursor; 
+    for ( ; ; ) {
+      double val; 
+      int rx = inp->next(cursor, inp_cx, val); 
+      if (rx < 0) break; 
+      out_elm->no = rx; 
+      out_elm->val = (AZ_MTX_FLOAT)val; 
+      ++out_elm; 
     }
   }
 }
@@ -80,6 +136,12 @@ void AzSmat::resize(int new_col_num)
   if (new_col_num < 0) {
     throw new AzException(eyec, "new #columns must be positive"); 
   }
+  if (pcol != NULL) {
+    int cx; 
+    for (cx = new_col_num; cx < col_num; ++cx) {
+      if (column[cx] != NULL) _delete_col(cx); /* not to be deleted by a */
+    }
+  }
   a.realloc(&column, new_col_num, eyec, "column"); 
   col_num = new_col_num; 
 }
@@ -118,7 +180,7 @@ void AzSmat::set(const AzReadOnlyMatrix *inp)
   initialize(inp->rowNum(), inp->colNum(), asDense); 
   int cx; 
   for (cx = 0; cx < col_num; ++cx) {
-    delete column[cx]; column[cx] = NULL; 
+    _delete_col(cx); 
     const AzReadOnlyVector *v = inp->col(cx); 
     if (!v->isZero()) {
       column[cx] = new AzSvect(v); 
@@ -129,23 +191,10 @@ void AzSmat::set(const AzReadOnlyMatrix *inp)
 /*-------------------------------------------------------------*/
 void AzSmat::set(const AzSmat *inp)  
 {
-  if (inp->row_num != this->row_num || 
-      inp->col_num != this->col_num) {
-    reform(inp->row_num, inp->col_num); 
-  }
-  int cx; 
-  for (cx = 0; cx < this->col_num; ++cx) {
-    if (inp->column[cx] == NULL) {
-      delete column[cx]; 
-      column[cx] = NULL; 
-    }
-    else {
-      if (column[cx] == NULL) {
-        column[cx] = new AzSvect(row_num); 
-      }
-      column[cx]->set(inp->column[cx]); 
-    }
+  if (inp == this) {
+    return; 
   }
+  _set_packed(inp); 
 }
 
 /*-------------------------------------------------------------*/
@@ -162,8 +211,7 @@ void AzSmat::set(const AzSmat *inp, int col0, int col1)
   for (cx = col0; cx < col1; ++cx) {
     int my_cx = cx - col0; 
     if (inp->column[cx] == NULL) {
-      delete column[my_cx]; 
-      column[my_cx] = NULL; 
+      _delete_col(my_cx); 
     }
     else {
       if (column[my_cx] == NULL) {
@@ -178,32 +226,24 @@ void AzSmat::set(const AzSmat *inp, int col0, int col1)
 int AzSmat::set(const AzSmat *inp, const int *cols, int cnum,  /* new2old */
                 bool do_zero_negaindex) 
 {
-  if (row_num != inp->row_num || col_num != cnum) {
-    reform(inp->row_num, cnum); 
-  }
   int negaindex = 0; 
   int my_col; 
   for (my_col = 0; my_col < cnum; ++my_col) {
     int col = cols[my_col]; 
     if (col < 0 && do_zero_negaindex) {
-      delete column[my_col]; 
-      column[my_col] = NULL;     
       ++negaindex; 
       continue; 
     }   
     if (col < 0 || col >= inp->col_num) {
       throw new AzException("AzSmat::set(inp,cols,cnum)", "invalid col#"); 
     }
-    if (inp->column[col] == NULL) {
-      delete column[my_col]; 
-      column[my_col] = NULL; 
-    }
-    else {
-      if (column[my_col] == NULL) {
-        column[my_col] = new AzSvect(row_num); 
-      }
-      column[my_col]->set(inp->column[col]); 
-    }
+  }
+  if (inp == this) {
+    AzSmat m(inp); 
+    _set_packed(&m, cols, cnum); 
+  }
+  else {
+    _set_packed(inp, cols, cnum); 
   }
   return negaindex; 
 }
@@ -226,7 +266,7 @@ void AzSmat::set(int col0, int col1, const AzSmat *inp, int i_col0)
   int col; 
   for (col = col0; col < col1; ++col, ++i_col) {
     if (inp->column[i_col] == NULL) {
-      delete column[col]; column[col] = NULL; 
+      _delete_col(col); 
     }
     else {
       if (column[col] == NULL) {
@@ -258,8 +298,7 @@ void AzSmat::reduce(const int *cols, int cnum)  /* new2old; must be sorted */
     
     if (old_col == new_col) {}
     else if (column[old_col] == NULL) {
-      delete column[new_col]; 
-      column[new_col] = NULL; 
+      _delete_col(new_col); 
     }
     else {
       if (column[new_col] == NULL) {
@@ -273,7 +312,8 @@ void AzSmat::reduce(const int *cols, int cnum)  /* new2old; must be sorted */
 
 /*-------------------------------------------------------------*/
 void AzSmat::transpose(AzSmat *m_out, 
-                       int col_begin, int col_end) const
+                       int col_begin, int col_end, 
+                       AzThreads *threads) const
 {
   int col_b = col_begin, col_e = col_end; 
   if (col_b < 0) {
@@ -288,52 +328,160 @@ void AzSmat::transpose(AzSmat *m_out,
     }
   }
 
-  _transpose(m_out, col_b, col_e); 
+  _transpose(m_out, col_b, col_e, threads); 
 }
 
 /*-------------------------------------------------------------*/
-void AzSmat::_transpose(AzSmat *m_out, 
-                        int col_begin, 
-                        int col_end) const
-{
-  int row_num = rowNum(); 
-
-  m_out->reform(col_end - col_begin, row_num); 
+/*  Transpose by chunks of the input columns, one task per chunk.      */
+/*  The chunks are in the order of the columns, so each output column  */
+/*  is filled in the ascending order of row# without sorting.  A task  */
+/*  goes through its chunk once per block of input rows, so that it    */
+/*  writes to a limited number of output columns at a time.            */
+/*-------------------------------------------------------------*/
+class AzSmat_TransposeTask : public virtual AzThreadTask {
+public:
+  const AzSmat *m_inp; 
+  int col_begin, col_end, chunk_size; 
+  int row_num; 
+  bool doCount; 
+  AZint8 *pos;      /* [tx*row_num+rx]: #elements, and then where to write */
+  AZI_VECT_ELM *out; /* sparse output */
+  double **dense;   /* dense output: [rx][cx-col_begin] */
 
-  AzIntArr ia_row_count; 
-  ia_row_count.reset(row_num, 0); 
-  int *row_count = ia_row_count.point_u(); 
+  static const int row_block = 4096; 
 
-  int cx; 
-  for (cx = col_begin; cx < col_end; ++cx) {
-    /* rewind(cx); */
-    AzCursor cursor; 
-    for ( ; ; ) {
-      double val; 
-      int rx = next(cursor, cx, val); 
-      if (rx < 0) break;
+  AzSmat_TransposeTask(const AzSmat *inp, int col_b, int col_e, int chunk_num) 
+    : m_inp(inp), col_begin(col_b), col_end(col_e), row_num(inp->rowNum()), 
+      doCount(false), pos(NULL), out(NULL), dense(NULL) {
+    chunk_size = (col_e - col_b + chunk_num - 1) / chunk_num; 
+  }
+  inline int chunkNum() const {
+    return (col_end - col_begin + chunk_size - 1) / chunk_size; 
+  }
+  void run(int tx, int thread_no) {
+    int cx0 = col_begin + tx*chunk_size; 
+    int cx1 = MIN(cx0 + chunk_size, col_end); 
+    if (doCount) count(pos + (AZint8)tx*row_num, cx0, cx1); 
+    else         fill(pos + (AZint8)tx*row_num, cx0, cx1); 
+  }
 
-      ++row_count[rx]; 
+protected:
+  void count(AZint8 *my_count, int cx0, int cx1) const {
+    int cx; 
+    for (cx = cx0; cx < cx1; ++cx) {
+      const AzSvect *v = m_inp->col(cx); 
+      const AZI_VECT_ELM *elm = v->elm; 
+      int ex; 
+      for (ex = 0; ex < v->elm_num; ++ex) {
+        if (elm[ex].val != 0) ++my_count[elm[ex].no]; 
+      }
     }
   }
-  int rx; 
-  for (rx = 0; rx < row_num; ++rx) {
-    if (row_count[rx] > 0) {
-      m_out->col_u(rx)->clear_prepare(row_count[rx]); 
+  void fill(AZint8 *my_pos, int cx0, int cx1) const {
+    AzIntArr ia_cur; 
+    ia_cur.reset(cx1-cx0, 0); 
+    int *cur = ia_cur.point_u(); 
+    int rx0; 
+    for (rx0 = 0; rx0 < row_num; rx0 += row_block) {
+      int rx1 = MIN(rx0 + row_block, row_num); 
+      int cx; 
+      for (cx = cx0; cx < cx1; ++cx) {
+        const AzSvect *v = m_inp->col(cx); 
+        const AZI_VECT_ELM *elm = v->elm; 
+        int ex = cur[cx-cx0]; 
+        for ( ; ex < v->elm_num && elm[ex].no < rx1; ++ex) {
+          if (elm[ex].val == 0) continue; 
+          if (dense != NULL) {
+            dense[elm[ex].no][cx-col_begin] = elm[ex].val; 
+          }
+          else {
+            AZI_VECT_ELM *e = out + my_pos[elm[ex].no]++; 
+            e->no = cx - col_begin; 
+            e->val = elm[ex].val; 
+          }
+        }
+        cur[cx-cx0] = ex; 
+      }
     }
   }
+}; 
 
-  for (cx = col_begin; cx < col_end; ++cx) {
-    /* rewind(cx); */
-    AzCursor cursor; 
-    for ( ; ; ) {
-      double val; 
-      int rx = next(cursor, cx, val); 
-      if (rx < 0) break;
+/*-------------------------------------------------------------*/
+static void run_tasks(AzThreadTask *task, int task_num, AzThreads *threads)
+{
+  if (threads != NULL) {
+    threads->run(task, task_num); 
+    return; 
+  }
+  int tx; 
+  for (tx = 0; tx < task_num; ++tx) task->run(tx, 0); 
+}
 
-      m_out->col_u(rx)->set_inOrder(cx - col_begin, val); 
+/*-------------------------------------------------------------*/
+void AzSmat::_transpose(AzSmat *m_out, 
+                        int col_begin, 
+                        int col_end, 
+                        AzThreads *threads) const
+{
+  const char *eyec = "AzSmat::_transpose"; 
+  int row_num = rowNum(); 
+  int c_num = col_end - col_begin; 
+  if (row_num <= 0 || c_num <= 0) {
+    m_out->reform(MAX(c_num, 0), row_num); 
+    return; 
+  }
+
+  /*---  #chunk is limited as the counts take #chunk x #row  ---*/
+  int thread_num = (threads != NULL) ? threads->threadNum() : 1; 
+  int chunk_num = MIN(thread_num*4, MAX(1, (1024*1024*16)/row_num)); 
+  chunk_num = MAX(1, MIN(chunk_num, c_num)); 
+  if (thread_num <= 1) chunk_num = 1; 
+  AzSmat_TransposeTask task(this, col_begin, col_end, chunk_num); 
+  chunk_num = task.chunkNum(); 
+
+  AzBaseArray<AZint8> _pos; 
+  task.pos = NULL; 
+  _pos.alloc(&task.pos, (AZint8)chunk_num*row_num, eyec, "pos"); 
+  AZint8 *pos = task.pos; 
+  memset(pos, 0, sizeof(pos[0])*chunk_num*row_num); 
+
+  task.doCount = true; 
+  run_tasks(&task, chunk_num, threads); 
+
+  /*---  row rx of chunk tx goes after row rx of the chunks before tx  ---*/
+  AzBaseArray<AZint8> _offs; 
+  AZint8 *offs = NULL; 
+  _offs.alloc(&offs, row_num+1, eyec, "offs"); 
+  offs[0] = 0; 
+  int rx; 
+  for (rx = 0; rx < row_num; ++rx) {
+    AZint8 total = offs[rx]; 
+    int tx; 
+    for (tx = 0; tx < chunk_num; ++tx) {
+      AZint8 num = pos[(AZint8)tx*row_num+rx]; 
+      pos[(AZint8)tx*row_num+rx] = total; 
+      total += num; 
     }
+    offs[rx+1] = total; 
   }
+
+  task.out = m_out->reform_packed(c_num, row_num, offs); 
+  task.doCount = false; 
+  run_tasks(&task, chunk_num, threads); 
+}
+
+/*-------------------------------------------------------------*/
+/* dense[rx]: output column for row rx, zeroed, of size colNum() */
+/*-------------------------------------------------------------*/
+void AzSmat::_transpose_dense(double **dense, 
+                              AzThreads *threads) const
+{
+  if (row_num <= 0 || col_num <= 0) return; 
+  int thread_num = (threads != NULL) ? threads->threadNum() : 1; 
+  int chunk_num = (thread_num <= 1) ? 1 : MIN(thread_num*4, col_num); 
+  AzSmat_TransposeTask task(this, 0, col_num, chunk_num); 
+  task.dense = dense; 
+  run_tasks(&task, task.chunkNum(), threads); 
 }
 
 /*-------------------------------------------------------------*/
@@ -604,8 +752,7 @@ void AzSmat::clear()
   int cx; 
   for (cx = 0; cx < col_num; ++cx) {
     if (column[cx] != NULL) {
-      delete column[cx]; 
-      column[cx] = NULL; 
+      _delete_col(cx); 
     }
   }
 }
@@ -1136,7 +1283,7 @@ void AzSvect::set(double val)
   }
   else {
     const char *eyec = "AzSvect::set (all)"; 
-    a.free(&elm); 
+    _free_elm(); 
     a.alloc(&elm, row_num, eyec, "elm"); 
     elm_num = row_num; 
     int ex; 
@@ -1319,6 +1466,7 @@ int AzSvect::to_insert(int row_no)
     }
   }
 
+  if (isView) _own(); 
   int elm_num_max = a.size(); 
   if (elm_num >= elm_num_max) {
     elm_num_max += inc(); 
@@ -1491,8 +1639,19 @@ double AzSvect::normalize1()
 /*-------------------------------------------------------------*/
 void AzSvect::clear()
 {
-  a.free(&elm); 
-  elm_num = 0; 
+  _free_elm(); 
+}
+
+/*-------------------------------------------------------------*/
+void AzSvect::_own()
+{
+  if (!isView) return; 
+  AZI_VECT_ELM *view = elm; 
+  elm = NULL; isView = false; 
+  if (elm_num > 0) {
+    a.alloc(&elm, elm_num, "AzSvect::_own", "elm"); 
+    memcpy(elm, view, sizeof(elm[0])*elm_num); 
+  }
 }
 
 /*-------------------------------------------------------------*/
@@ -1706,6 +1865,7 @@ void AzSvect::set_inOrder(int row_no, double val)
 
   int where = elm_num; 
 
+  if (isView) _own(); 
   int elm_num_max = a.size(); 
   if (elm_num >= elm_num_max) {
     elm_num_max += inc(); 
@@ -1747,6 +1907,26 @@ void AzSvect::load(const AzIFarr *ifa_row_val)
   }
 }
 
+/*-------------------------------------------------------------*/
+void AzSvect::load(const int *row_no, const double *val, int num)
+{  
+  clear_prepare(num); 
+  int prev_row = -1; 
+  int ix; 
+  for (ix = 0; ix < num; ++ix) {
+    int row = row_no[ix]; 
+    if (row < 0 || row >= row_num || /* out of range */
+        row <= prev_row) { /* out of order */
+      throw new AzException("AzSvect::load(row_no,val)", "Invalid input"); 
+    }
+    elm[elm_num].no = row; 
+    _checkVal(val[ix]); 
+    elm[elm_num].val = (AZ_MTX_FLOAT)val[ix]; 
+    ++elm_num; 
+    prev_row = row; 
+  }
+}
+
 /*-------------------------------------------------------------*/
 bool AzSmat::isSame(const AzSmat *inp) const
 {
@@ -1762,6 +1942,40 @@ bool AzSmat::isSame(const AzSmat *inp) const
   return true; 
 }
 
+/*-------------------------------------------------------------*/
+/* FNV-1a */
+static inline void _hash_bytes(unsigned long long &h, const void *bytes, int len)
+{
+  const AzByte *b = (const AzByte *)bytes; 
+  int ix; 
+  for (ix = 0; ix < len; ++ix) {
+    h ^= b[ix]; 
+    h *= 1099511628211ULL; 
+  }
+}
+
+/*-------------------------------------------------------------*/
+AZint8 AzSmat::hash() const
+{
+  unsigned long long h = 14695981039346656037ULL; 
+  _hash_bytes(h, &row_num, sizeof(row_num)); 
+  _hash_bytes(h, &col_num, sizeof(col_num)); 
+  int cx; 
+  for (cx = 0; cx < col_num; ++cx) {
+    _hash_bytes(h, &cx, sizeof(cx)); 
+    if (isZero(cx)) continue; 
+    AzCursor cur; 
+    for ( ; ; ) {
+      double val; 
+      int row = column[cx]->next(cur, val); /* nonzero only as isSame */
+      if (row == AzNone) break; 
+      _hash_bytes(h, &row, sizeof(row)); 
+      _hash_bytes(h, &val, sizeof(val)); 
+    }
+  }
+  return (AZint8)h; 
+}
+
 /*-------------------------------------------------------------*/
 bool AzSvect::isSame(const AzSvect *inp) const
 {
@@ -35,6 +35,7 @@ typedef struct {
 } AZI_VECT_ELM; 
 
 class AzSmat; 
+class AzThreads; 
 
 //! sparse vector 
 class AzSvect : /* implements */ public virtual AzReadOnlyVector {
@@ -43,25 +44,38 @@ protected:
   AZI_VECT_ELM *elm; 
   AzBaseArray<AZI_VECT_ELM> a; 
   int elm_num; 
+  bool isView; /* elm points into the packed storage of AzSmat; a is empty */
 
   void _release() {
-    a.free(&elm); elm_num = 0; 
+    _free_elm(); 
   }
+  inline void _free_elm() {
+    if (isView) {
+      elm = NULL; isView = false; 
+    }
+    else {
+      a.free(&elm); 
+    }
+    elm_num = 0; 
+  }
+  void _own(); /* copy the elements of a view to its own memory */
 
 public:
   friend class AzDmat; 
   friend class AzDvect; 
   friend class AzPmatSpa; 
+  friend class AzSmat; 
+  friend class AzSmat_TransposeTask; 
   
-  AzSvect() : row_num(0), elm(NULL), elm_num(0) {}
-  AzSvect(int inp_row_num, bool asDense=false) : row_num(0), elm(NULL), elm_num(0) {
+  AzSvect() : row_num(0), elm(NULL), elm_num(0), isView(false) {}
+  AzSvect(int inp_row_num, bool asDense=false) : row_num(0), elm(NULL), elm_num(0), isView(false) {
     initialize(inp_row_num, asDense); 
   }
-  AzSvect(const AzSvect *inp) : row_num(0), elm(NULL), elm_num(0) {
+  AzSvect(const AzSvect *inp) : row_num(0), elm(NULL), elm_num(0), isView(false) {
     row_num = inp->row_num;  
     set(inp); 
   }
-  AzSvect(const AzSvect &inp) : row_num(0), elm(NULL), elm_num(0) {
+  AzSvect(const AzSvect &inp) : row_num(0), elm(NULL), elm_num(0), isView(false) {
     row_num = inp.row_num; 
     set(&inp); 
   }
@@ -72,11 +86,11 @@ public:
     set(&inp); 
     return *this; 
   }
-  AzSvect(const AzReadOnlyVector *inp) : row_num(0), elm(NULL), elm_num(0) {
+  AzSvect(const AzReadOnlyVector *inp) : row_num(0), elm(NULL), elm_num(0), isView(false) {
     row_num = inp->rowNum();  
     set(inp); 
   }
-  AzSvect(AzFile *file) : row_num(0), elm(NULL), elm_num(0) {
+  AzSvect(AzFile *file) : row_num(0), elm(NULL), elm_num(0), isView(false) {
     _read(file); 
   }
   ~AzSvect() {}
@@ -95,6 +109,7 @@ public:
   inline int rowNum() const { return row_num; }  
   void load(const AzIntArr *ia_row, double val, bool do_ignore_negative_rowno=false); 
   void load(const AzIFarr *ifa_row_val); 
+  void load(const int *row_no, const double *val, int num); /* row# must be in the ascending order */
   void load(AzIFarr *ifa_row_val) {
     ifa_row_val->sort_Int(true); 
     load((const AzIFarr *)ifa_row_val); 
@@ -200,20 +215,45 @@ protected:
   AzSvect **column; /* NULL if and only if col_num=0 */
   AzObjPtrArray<AzSvect> a; 
   AzSvect dummy_zero; 
+
+  /*---  packed storage (see reform_packed)  ---*/
+  AzSvect *pcol;      /* column objects; column[cx] is &pcol[cx] or NULL */
+  AzObjArray<AzSvect> a_pcol; 
+  AZI_VECT_ELM *pelm; /* elements of all the columns, column by column */
+  AzBaseArray<AZI_VECT_ELM,AZint8> a_pelm; 
+
   void _release() {
+    _release_packed(); 
     a.free(&column); col_num = 0; 
     row_num = 0; 
   }
+  void _release_packed() {
+    if (pcol == NULL) return; 
+    int cx; 
+    for (cx = 0; cx < col_num; ++cx) {
+      if (isPackedCol(column[cx])) column[cx] = NULL; /* not to be deleted by a */
+    }
+    a_pcol.free(&pcol); 
+    a_pelm.free(&pelm); 
+  }
+  inline bool isPackedCol(const AzSvect *v) const {
+    return (pcol != NULL && v >= pcol && v < pcol + a_pcol.size()); 
+  }
+  inline void _delete_col(int cx) {
+    if (isPackedCol(column[cx])) column[cx]->clear(); 
+    else                         delete column[cx]; 
+    column[cx] = NULL; 
+  }
 public: 
-  AzSmat() : col_num(0), row_num(0), column(NULL) {}
+  AzSmat() : col_num(0), row_num(0), column(NULL), pcol(NULL), pelm(NULL) {}
   AzSmat(int inp_row_num, int inp_col_num, bool asDense=false)
-    : col_num(0), row_num(0), column(NULL) {
+    : col_num(0), row_num(0), column(NULL), pcol(NULL), pelm(NULL) {
     initialize(inp_row_num, inp_col_num, asDense); 
   }
-  AzSmat(const AzSmat *inp) : col_num(0), row_num(0), column(NULL) {
+  AzSmat(const AzSmat *inp) : col_num(0), row_num(0), column(NULL), pcol(NULL), pelm(NULL) {
     initialize(inp); 
   }
-  AzSmat(const AzSmat &inp) : col_num(0), row_num(0), column(NULL) {
+  AzSmat(const AzSmat &inp) : col_num(0), row_num(0), column(NULL), pcol(NULL), pelm(NULL) {
     initialize(&inp); 
   }
   AzSmat & operator =(const AzSmat &inp) {
@@ -223,13 +263,15 @@ public:
     return *this; 
   }
 
-  AzSmat(AzFile *file) : col_num(0), row_num(0), column(NULL) {
+  AzSmat(AzFile *file) : col_num(0), row_num(0), column(NULL), pcol(NULL), pelm(NULL) {
     _read(file); 
   }
-  AzSmat(const char *fn) : col_num(0), row_num(0), column(NULL) {
+  AzSmat(const char *fn) : col_num(0), row_num(0), column(NULL), pcol(NULL), pelm(NULL) {
     read(fn); 
   }
-  ~AzSmat() {}
+  ~AzSmat() {
+    _release(); 
+  }
   void read(AzFile *file) {
     _release(); 
     _read(file); 
@@ -263,7 +305,9 @@ public:
   int nonZeroColNum() const; 
   double nonZeroNum(double *ratio=NULL) const; 
 
-  void transpose(AzSmat *m_out, int col_begin = -1, int col_end = -1) const; 
+  /*---  threads: to transpose in parallel; may be NULL  ---*/
+  void transpose(AzSmat *m_out, int col_begin = -1, int col_end = -1, 
+                 AzThreads *threads = NULL) const; 
   inline void transpose_to(AzSmat *m_out, int col_begin = -1, int col_end = -1) const {
     transpose(m_out, col_begin, col_end); 
   }
@@ -353,11 +397,21 @@ public:
   }
   inline void destroy(int col) {
     if (col >= 0 && col < col_num && column != NULL) {
-      delete column[col]; 
-      column[col] = NULL; 
+      _delete_col(col); 
     } 
   }
 
+  /*---  packed storage: the elements of all the columns in one block  ---*/
+  /*---  instead of one allocation per column.  set(AzSmat*), copying, ---*/
+  /*---  and transpose make packed matrices.  Columns can be changed as ---*/
+  /*---  usual; a column that grows gets its own memory.                ---*/
+  /*---  reform_packed returns the block; the caller fills column cx  ---*/
+  /*---  at [col_offs[cx], col_offs[cx+1]) in the ascending order of   ---*/
+  /*---  row#.                                                         ---*/
+  AZI_VECT_ELM *reform_packed(int row_num, int col_num, 
+                              const AZint8 *col_offs); /* [col_num+1] */
+  inline bool isPacked() const { return (pcol != NULL); }
+
   inline void load(int col, AzIFarr *ifa_row_val) {
     col_u(col)->load(ifa_row_val); 
   }
@@ -377,6 +431,7 @@ public:
             int cut_num = -1) const; 
 
   bool isSame(const AzSmat *inp) const; 
+  AZint8 hash() const; /* 64-bit hash of the size and the nonzero components */
 
   static void concat(AzSmat *m_array[], 
                      int m_num, 
@@ -400,7 +455,10 @@ protected:
   void _read(AzFile *file); 
   void initialize(int row_num, int col_num, bool asDense); 
   void initialize(const AzSmat *inp); 
-  void _transpose(AzSmat *m_out, int col_begin, int col_end) const; 
+  friend class AzDmat; 
+  void _transpose(AzSmat *m_out, int col_begin, int col_end, AzThreads *threads) const; 
+  void _transpose_dense(double **dense, AzThreads *threads) const; 
+  void _set_packed(const AzSmat *inp, const int *cols=NULL, int cnum=-1); 
 }; 
  
 /*********************************************************************/
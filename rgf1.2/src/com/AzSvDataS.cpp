@@ -16,8 +16,10 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  * * * * */
 
+#include <float.h>
 #include "AzSvDataS.hpp"
 #include "AzTools.hpp"
+#include "AzThreads.hpp"
 
 /*------------------------------------------------------------------*/
 void AzSvDataS::reset()
@@ -70,8 +72,8 @@ void AzSvDataS::_read(const char *feat_fn,
 {
   reset(); 
 
-  read_feat(feat_fn, fdic_fn, &m_feat, &sp_f_dic, max_data_num); 
-  read_target(y_fn, &v_y, max_data_num); 
+  read_feat(feat_fn, fdic_fn, &m_feat, &sp_f_dic, max_data_num, thread_num); 
+  read_target(y_fn, &v_y, max_data_num, thread_num); 
 
   /*---  check the dimensionalty  ---*/
   int f_data_num = m_feat.colNum(); 
@@ -90,7 +92,7 @@ void AzSvDataS::read_features_only(const char *feat_fn,
                                    int max_data_num)
 {
   reset(); 
-  read_feat(feat_fn, fdic_fn, &m_feat, &sp_f_dic, max_data_num); 
+  read_feat(feat_fn, fdic_fn, &m_feat, &sp_f_dic, max_data_num, thread_num); 
   int data_num = m_feat.colNum(); 
   v_y.reform(data_num); /* fill with dummy value zero */
 }
@@ -100,7 +102,7 @@ void AzSvDataS::read_targets_only(const char *y_fn,
                                   int max_data_num)
 {
   reset(); 
-  read_target(y_fn, &v_y, max_data_num); 
+  read_target(y_fn, &v_y, max_data_num, thread_num); 
   int data_num = v_y.rowNum(); 
   m_feat.reform(1, data_num); /* dummy features */
 }
@@ -112,7 +114,8 @@ void AzSvDataS::read_feat(const char *feat_fn,
                           /*---  output  ---*/
                           AzSmat *m_feat, 
                           AzStrPool *sp_f_dic, 
-                          int max_data_num)
+                          int max_data_num, 
+                          int thread_num)
 {
   /*---  read feature names  ---*/
   int f_num = -1; 
@@ -131,7 +134,7 @@ void AzSvDataS::read_feat(const char *feat_fn,
   }
 
   /*---  read feature file  ---*/
-  readData(feat_fn, -1, m_feat, max_data_num); 
+  readData(feat_fn, -1, m_feat, max_data_num, thread_num); 
 
   if (f_num > 0 && f_num != m_feat->rowNum()) {
     AzBytArr s("Conflict in #feature: "); s.c(feat_fn); s.c(" vs. "); s.c(fdic_fn); 
@@ -141,10 +144,11 @@ void AzSvDataS::read_feat(const char *feat_fn,
 
 /*------------------------------------------------------------------*/
 /* static */
-void AzSvDataS::read_target(const char *y_fn, AzDvect *v_y, int max_data_num)
+void AzSvDataS::read_target(const char *y_fn, AzDvect *v_y, int max_data_num, 
+                            int thread_num)
 {
   AzSmat m_y; 
-  readData(y_fn, 1, &m_y, max_data_num); 
+  readData(y_fn, 1, &m_y, max_data_num, thread_num); 
   int y_data_num = m_y.colNum(); 
   v_y->reform(y_data_num); 
   int dx; 
@@ -154,6 +158,40 @@ void AzSvDataS::read_target(const char *y_fn, AzDvect *v_y, int max_data_num)
   }
 }                       
 
+/*------------------------------------------------------------------*/
+void AzSvDataS::parseLines(const AzStrPool *sp_lines, 
+                           int f_num, 
+                           bool isSparse, 
+                           /*---  output  ---*/
+                           AzSmat *m_feat)
+{
+  const char *eyec = "AzSvDataS::parseLines"; 
+  const char *data_fn = "(input lines)"; 
+  int data_num = sp_lines->size(); 
+  if (f_num <= 0 && data_num > 0) {
+    if (isSparse) {
+      throw new AzException(AzInputError, eyec, "The feature dimensionality is unknown; it is needed for sparse data"); 
+    }
+    const char *line = sp_lines->c_str(0); 
+    f_num = countFeatures((AzByte *)line, (AzByte *)line+Az64::cstrlen(line)); 
+    if (f_num <= 0) {
+      throw new AzException(AzInputNotValid, eyec, "The first line is empty"); 
+    }
+  }
+  m_feat->reform(MAX(f_num, 0), data_num); 
+  int dx; 
+  for (dx = 0; dx < data_num; ++dx) {
+    const char *line = sp_lines->c_str(dx); 
+    int len = Az64::cstrlen(line); 
+    if (isSparse) {
+      parseDataLine_Sparse((AzByte *)line, len, f_num, data_fn, dx+1, m_feat, dx); 
+    }
+    else {
+      parseDataLine((AzByte *)line, len, f_num, data_fn, dx+1, m_feat, dx); 
+    }
+  }
+}
+
 /*------------------------------------------------------------------*/
 void AzSvDataS::_parseDataLine(const AzByte *inp, 
                               int inp_len, 
@@ -322,12 +360,132 @@ void AzSvDataS::readData_Small(const char *data_fn,
 }
 #endif 
 
+/*------------------------------------------------------------------*/
+/*  Elements parsed by a task, line by line; the lines are packed into  */
+/*  the matrix when all the lines are parsed.                            */
+/*------------------------------------------------------------------*/
+class AzSvDataS_Parsed {
+public:
+  AzBaseArray<AZI_VECT_ELM,AZint8> a; 
+  AZI_VECT_ELM *elm; 
+  AZint8 elm_num; 
+
+  AzSvDataS_Parsed() : elm(NULL), elm_num(0) {}
+  int put(const AzIFarr *ifa) { /* returns the number of elements */
+    int num = ifa->size(); 
+    if (elm_num + num > a.size()) {
+      a.realloc(&elm, MAX(a.size()*2, elm_num+num+1024), "AzSvDataS_Parsed::put", "elm"); 
+    }
+    int ix; 
+    for (ix = 0; ix < num; ++ix, ++elm_num) {
+      elm[elm_num].val = (AZ_MTX_FLOAT)ifa->get(ix, &elm[elm_num].no); 
+    }
+    return num; 
+  }
+}; 
+
+/*------------------------------------------------------------------*/
+class AzSvDataS_Packer {
+protected:
+  AzObjPtrArray<AzSvDataS_Parsed> a; 
+  AzSvDataS_Parsed **parsed; /* in the order of the lines */
+  int parsed_num; 
+  AzIntArr ia_elm_num; /* per line */
+
+public:
+  AzSvDataS_Packer(int data_num) : parsed(NULL), parsed_num(0) {
+    ia_elm_num.reset(data_num, 0); 
+  }
+  ~AzSvDataS_Packer() {
+    a.free(&parsed); 
+  }
+  inline int *elm_num() { return ia_elm_num.point_u(); }
+  AzSvDataS_Parsed **new_parsed(int num) {
+    if (parsed_num + num > a.size()) {
+      a.realloc(&parsed, MAX(a.size()*2, parsed_num+num), "AzSvDataS_Packer::new_parsed", "parsed"); 
+    }
+    AzSvDataS_Parsed **out = parsed + parsed_num; 
+    int ix; 
+    for (ix = 0; ix < num; ++ix) out[ix] = new AzSvDataS_Parsed(); 
+    parsed_num += num; 
+    return out; 
+  }
+  void pack(int f_num, AzSmat *m_feat) {
+    const char *eyec = "AzSvDataS_Packer::pack"; 
+    int data_num = ia_elm_num.size(); 
+    const int *num = ia_elm_num.point(); 
+    AzBaseArray<AZint8> _offs; 
+    AZint8 *offs = NULL; 
+    _offs.alloc(&offs, data_num+1, eyec, "offs"); 
+    offs[0] = 0; 
+    int dx; 
+    for (dx = 0; dx < data_num; ++dx) offs[dx+1] = offs[dx] + num[dx]; 
+
+    AZI_VECT_ELM *out = m_feat->reform_packed(f_num, data_num, offs); 
+    AZint8 pos = 0; 
+    int px; 
+    for (px = 0; px < parsed_num; ++px) {
+      AZint8 len = parsed[px]->elm_num; 
+      if (pos + len > offs[data_num]) {
+        throw new AzException(eyec, "conflict in #elements"); 
+      }
+      if (len > 0) memcpy(out+pos, parsed[px]->elm, sizeof(out[0])*len); 
+      pos += len; 
+      delete parsed[px]; parsed[px] = NULL; /* to save memory */
+    }
+    if (pos != offs[data_num]) {
+      throw new AzException(eyec, "conflict in #elements"); 
+    }
+  }
+}; 
+
+/*------------------------------------------------------------------*/
+/*  Parse the lines in a block read from a data file; a task is a range  */
+/*  of lines, and each line goes to its own column of the matrix.        */
+/*------------------------------------------------------------------*/
+class AzSvDataS_ParseTask : public virtual AzThreadTask {
+public:
+  const AzByte *block; 
+  const AZint8 *line_offs; /* offsets in the block; [ix] to [ix+1] */
+  int line_num, lines_per_task; 
+  int f_num; 
+  bool isSparse; 
+  const char *data_fn; 
+  int first_line_no, first_dx; 
+  AzSvDataS_Parsed **parsed; /* [tx]: output of task#tx */
+  int *elm_num; /* [dx]: #elements of data point#dx */
+
+  inline int taskNum() const {
+    return (line_num+lines_per_task-1)/lines_per_task; 
+  }
+  void run(int tx, int thread_no) {
+    int ix0 = tx*lines_per_task; 
+    int ix1 = MIN(ix0+lines_per_task, line_num); 
+    AzIFarr ifa_ex_val; 
+    int ix; 
+    for (ix = ix0; ix < ix1; ++ix) {
+      const AzByte *line = block + line_offs[ix]; 
+      int len = (int)(line_offs[ix+1] - line_offs[ix]); 
+      ifa_ex_val.reset(); 
+      if (isSparse) {
+        AzSvDataS::_parseDataLine_Sparse(line, len, f_num, data_fn, first_line_no+ix+1, ifa_ex_val); 
+        ifa_ex_val.sort_Int(true); 
+      }
+      else {
+        AzSvDataS::_parseDataLine(line, len, f_num, data_fn, first_line_no+ix+1, ifa_ex_val); 
+      }
+      elm_num[first_dx+ix] = parsed[tx]->put(&ifa_ex_val); 
+    }
+  }
+}; 
+
 /*------------------------------------------------------------------*/
 void AzSvDataS::readData_Large(const char *data_fn, 
                          int expected_f_num, 
                          /*---  output  ---*/
                          AzSmat *m_feat,
-                         int max_data_num)
+                         int max_data_num, 
+                         int thread_num)
 {
   const char *eyec = "AzSvDataS::readData_Large"; 
 
@@ -371,32 +529,162 @@ void AzSvDataS::readData_Large(const char *data_fn,
     if (f_num <= 0) {
       throw new AzException(AzInputNotValid, eyec, "No feature in the first line"); 
     }
-    file.seek(0);  /* rewind to the beginning */
   }
 
   /*---  read features  ---*/
   if (max_data_num > 0) {
     data_num = MIN(data_num, max_data_num); 
   }
-  m_feat->reform(f_num, data_num); 
-  
-  int dx; 
-  for (dx = 0; dx < data_num; ++dx, ++line_no) {
-    int len = ia_line_len.get(line_no); 
-    file.readBytes(buff, len); 
-    buff[len] = '\0';  /* to make it a C string */
-    if (isSparse) {
-      parseDataLine_Sparse(buff, len, f_num, data_fn, line_no+1,
-                    m_feat, dx); 
+  AzSvDataS_Packer packer(data_num); 
+
+  /*---  read blocks of lines sequentially, and parse the lines in a block in parallel  ---*/
+  AzThreads threads; 
+  threads.reset(thread_num); 
+  const AZint8 block_size_max = MAX((AZint8)64*1024*1024, (AZint8)max_line_len); 
+  AzBaseArray<AZint8> _line_offs; 
+  AZint8 *line_offs = NULL; 
+  AZint8 offs = (line_no > 0) ? ia_line_len.get(0) : 0; 
+  AZint8 buff_size = -1; 
+  int dx = 0; 
+  while (dx < data_num) {
+    /*---  lines in this block  ---*/
+    int dx_end = dx; 
+    AZint8 block_size = 0; 
+    for ( ; dx_end < data_num; ++dx_end) {
+      int len = ia_line_len.get(line_no+dx_end-dx); 
+      if (dx_end > dx && block_size + len > block_size_max) break; 
+      block_size += len; 
     }
-    else {
-      parseDataLine(buff, len, f_num, data_fn, line_no+1, 
-                    m_feat, dx); 
+    int line_num = dx_end - dx; 
+    if (buff_size < block_size + 1) {
+      buff_size = block_size + 1; 
+      buff = ba_buff.reset((int)buff_size, 0); 
+    }
+    if (_line_offs.size() < line_num+1) {
+      _line_offs.free(&line_offs); 
+      _line_offs.alloc(&line_offs, line_num+1, eyec, "line_offs"); 
+    }
+    file.seekReadBytes(offs, block_size, buff); 
+    buff[block_size] = '\0';  /* to make the last line a C string */
+    line_offs[0] = 0; 
+    int ix; 
+    for (ix = 0; ix < line_num; ++ix) {
+      line_offs[ix+1] = line_offs[ix] + ia_line_len.get(line_no+ix); 
     }
+
+    AzSvDataS_ParseTask task; 
+    task.block = buff; 
+    task.line_offs = line_offs; 
+    task.line_num = line_num; 
+    task.lines_per_task = MAX(1, MIN(1024, line_num/(threads.threadNum()*4))); 
+    task.f_num = f_num; 
+    task.isSparse = isSparse; 
+    task.data_fn = data_fn; 
+    task.first_line_no = line_no; 
+    task.first_dx = dx; 
+    task.parsed = packer.new_parsed(task.taskNum()); 
+    task.elm_num = packer.elm_num(); 
+    threads.run(&task, task.taskNum()); 
+
+    offs += block_size; 
+    line_no += line_num; 
+    dx = dx_end; 
   }
   file.close(); 
+  packer.pack(f_num, m_feat); 
 }                            
 
+/*------------------------------------------------------------------*/
+/*  Binary data file: magic, marker, #row(=#feat), #col(=#data), #nz, */
+/*  offsets of the columns (#col+1), and then for each column,        */
+/*  row# (int) followed by values (double).                           */
+/*------------------------------------------------------------------*/
+#define AzSvDataS_BinaryMagic "#AzCSC1\n"
+static const int AzSvDataS_BinaryMagicLen = 8; 
+
+/*------------------------------------------------------------------*/
+bool AzSvDataS::isBinary(const char *data_fn)
+{
+  if (data_fn == NULL || !AzFile::isExisting(data_fn)) return false; 
+  AzFile file(data_fn); 
+  file.open("rb"); 
+  if (file.size() < AzSvDataS_BinaryMagicLen) {
+    file.close(); 
+    return false; 
+  }
+  char magic[AzSvDataS_BinaryMagicLen]; 
+  file.seekReadBytes(0, AzSvDataS_BinaryMagicLen, magic); 
+  file.close(); 
+  return (memcmp(magic, AzSvDataS_BinaryMagic, AzSvDataS_BinaryMagicLen) == 0); 
+}
+
+/*------------------------------------------------------------------*/
+void AzSvDataS::writeData_Binary(const char *data_fn, 
+                                 const AzSmat *m_data)
+{
+  int row_num = m_data->rowNum(), col_num = m_data->colNum(); 
+  AzBaseArray<AZint8> _colptr; 
+  AZint8 *colptr = NULL; 
+  _colptr.alloc(&colptr, col_num+1, "AzSvDataS::writeData_Binary", "colptr"); 
+  colptr[0] = 0; 
+  int max_nz = 0; 
+  int col; 
+  for (col = 0; col < col_num; ++col) {
+    int nz = m_data->col(col)->nonZeroRowNum(); 
+    colptr[col+1] = colptr[col] + nz; 
+    max_nz = MAX(max_nz, nz); 
+  }
+
+  AzFile file(data_fn); 
+  file.open("wb"); 
+  file.writeBytes(AzSvDataS_BinaryMagic, AzSvDataS_BinaryMagicLen); 
+  file.writeBinMarker(); 
+  file.writeInt(row_num); 
+  file.writeInt(col_num); 
+  file.writeInt8(colptr[col_num]); 
+  for (col = 0; col <= col_num; ++col) {
+    file.writeInt8(colptr[col]); 
+  }
+
+  AzIntArr ia_row; 
+  AzDvect v_val(max_nz); 
+  AzIFarr ifa_nz; 
+  for (col = 0; col < col_num; ++col) {
+    ifa_nz.reset(); 
+    m_data->col(col)->nonZero(&ifa_nz); 
+    int num = ifa_nz.size(); 
+    ia_row.reset(num, 0); 
+    int *row = ia_row.point_u(); 
+    double *val = v_val.point_u(); 
+    int ix; 
+    for (ix = 0; ix < num; ++ix) {
+      val[ix] = ifa_nz.get(ix, &row[ix]); 
+      AzFile::swap_int4(&row[ix]); 
+      AzFile::swap_double(&val[ix]); 
+    }
+    file.writeBytes(row, (AZint8)sizeof(int)*num); 
+    file.writeBytes(val, (AZint8)sizeof(double)*num); 
+  }
+  file.close(true); 
+}
+
+/*------------------------------------------------------------------*/
+void AzSvDataS::readData_Binary(const char *data_fn, 
+                         int expected_f_num, 
+                         /*---  output  ---*/
+                         AzSmat *m_feat,
+                         int max_data_num)
+{
+  AzSvDataS_Stream stream; 
+  stream.open(data_fn, expected_f_num); 
+  int data_num = stream.dataNum(); 
+  if (max_data_num > 0) {
+    data_num = MIN(data_num, max_data_num); 
+  }
+  stream.read(data_num, m_feat); 
+  stream.close(); 
+}
+
 /*------------------------------------------------------------------*/
 void AzSvDataS::_parseDataLine_Sparse(const AzByte *inp, 
                               int inp_len, 
@@ -461,6 +749,78 @@ void AzSvDataS::decomposeFeat(const char *token,
   }
 }
 
+/*-------------------------------------------------------------*/
+/* Same result as atof.  A plain decimal with at most 15-16 significant */
+/* digits and a small exponent is converted by one exact multiplication */
+/* or division (correctly rounded like strtod); anything else goes to   */
+/* atof.                                                                */
+/*-------------------------------------------------------------*/
+double AzSvDataS::parse_double(const char *str)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0 /* no extended precision */
+  static const double pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 
+  }; 
+  const int max_exp10 = 22; 
+  const unsigned long long max_mantissa = 1ULL << 53; 
+
+  const char *wp = str; 
+  bool isNega = false; 
+  if (*wp == '+' || *wp == '-') {
+    isNega = (*wp == '-'); 
+    ++wp; 
+  }
+  unsigned long long mantissa = 0; 
+  int exp10 = 0; 
+  bool hasDigit = false; 
+  for ( ; *wp >= '0' && *wp <= '9'; ++wp) {
+    hasDigit = true; 
+    if (mantissa >= max_mantissa) return atof(str); 
+    mantissa = mantissa*10 + (*wp - '0'); 
+  }
+  if (*wp == '.') {
+    for (++wp; *wp >= '0' && *wp <= '9'; ++wp) {
+      hasDigit = true; 
+      if (mantissa >= max_mantissa) return atof(str); 
+      mantissa = mantissa*10 + (*wp - '0'); 
+      --exp10; 
+    }
+  }
+  if (!hasDigit) return atof(str); 
+  if (*wp == 'e' || *wp == 'E') {
+    const char *ep = wp + 1; 
+    bool isExpNega = false; 
+    if (*ep == '+' || *ep == '-') {
+      isExpNega = (*ep == '-'); 
+      ++ep; 
+    }
+    if (*ep < '0' || *ep > '9') return atof(str); 
+    int e = 0; 
+    for ( ; *ep >= '0' && *ep <= '9'; ++ep) {
+      if (e > 1000) return atof(str); 
+      e = e*10 + (*ep - '0'); 
+    }
+    exp10 += (isExpNega) ? -e : e; 
+    wp = ep; 
+  }
+  /*---  something atof might take as part of the number (e.g., hex)  ---*/
+  if ((*wp >= '0' && *wp <= '9') || (*wp >= 'a' && *wp <= 'z') || 
+      (*wp >= 'A' && *wp <= 'Z') || *wp == '.') {
+    return atof(str); 
+  }
+  if (mantissa > max_mantissa || exp10 < -max_exp10 || exp10 > max_exp10) {
+    return atof(str); 
+  }
+  double val = (double)mantissa; 
+  if (exp10 < 0) val /= pow10[-exp10]; 
+  else           val *= pow10[exp10]; 
+  return (isNega) ? -val : val; 
+#else
+  return atof(str); 
+#endif 
+}
+
 /*------------------------------------------------------------------*/
 int AzSvDataS::if_sparse(AzBytArr &s_line, 
                          int expected_f_num, 
@@ -587,4 +947,253 @@ void AzSvDataS::mergeData(const AzSmat *m_x,
   m.transpose(&m1); 
   m1.writeText(out_x_fn, digits, doSparse); 
 }
- 
\ No newline at end of file
+ 
+
+/*------------------------------------------------------------------*/
+/*------------------------------------------------------------------*/
+void AzSvDataS_Stream::open(const char *fn, 
+                            int expected_f_num, 
+                            int thread_num)
+{
+  const char *eyec = "AzSvDataS_Stream::open"; 
+  close(); 
+  s_fn.reset(fn); 
+  isSparse = false; 
+  f_num = 0; 
+  line_no = data_no = 0; 
+  buff_beg = buff_end = 0; 
+  isEof = false; 
+
+  isBinary = AzSvDataS::isBinary(fn); 
+  file = new AzFile(fn); 
+  file->open("rb"); 
+  if (isBinary) {
+    open_binary(expected_f_num); 
+    return; 
+  }
+
+  threads.reset(thread_num); 
+  if (_buff.size() <= 0) {
+    _buff.alloc(&buff, buff_size_init+1, eyec, "buff"); /* +1 for '\0' */
+  }
+
+  /*---  1st line indicates sparse/dense  ---*/
+  const AzByte *nl = NULL; 
+  for ( ; ; ) {
+    nl = (const AzByte *)memchr(buff+buff_beg, '\n', buff_end-buff_beg); 
+    if (nl != NULL || !fill_buff()) break; 
+  }
+  int line0_len = (nl != NULL) ? (int)(nl + 1 - (buff+buff_beg)) : buff_end-buff_beg; 
+  if (line0_len <= 0) {
+    throw new AzException(AzInputNotValid, eyec, "Empty data: ", fn); 
+  }
+  AzBytArr s_line0(buff+buff_beg, line0_len); 
+  f_num = AzSvDataS::if_sparse(s_line0, expected_f_num); 
+  if (f_num > 0) {
+    isSparse = true; 
+    buff_beg += line0_len; 
+    line_no = 1; /* first data line */
+  }
+  else {
+    f_num = expected_f_num; 
+    if (f_num <= 0) {
+      const AzByte *line0 = s_line0.point(); 
+      f_num = AzSvDataS::countFeatures(line0, line0+line0_len); 
+    }
+    if (f_num <= 0) {
+      throw new AzException(AzInputNotValid, eyec, "No feature in the first line: ", fn); 
+    }
+  }
+}
+
+/*------------------------------------------------------------------*/
+int AzSvDataS_Stream::read(int max_num, 
+                           AzSmat *m_feat)
+{
+  if (file == NULL) {
+    throw new AzException("AzSvDataS_Stream::read", "No file is open"); 
+  }
+  if (isBinary) return read_binary(max_num, m_feat); 
+  else          return read_text(max_num, m_feat); 
+}
+
+/*------------------------------------------------------------------*/
+bool AzSvDataS_Stream::fill_buff()
+{
+  if (isEof) return false; 
+
+  /*---  move the remaining bytes to the beginning  ---*/
+  if (buff_beg > 0) {
+    memmove(buff, buff+buff_beg, buff_end-buff_beg); 
+    buff_end -= buff_beg; 
+    buff_beg = 0; 
+  }
+  int buff_size = _buff.size() - 1; /* -1 for '\0' */
+  if (buff_end >= buff_size) { /* a line longer than the buffer */
+    _buff.realloc(&buff, buff_size*2+1, "AzSvDataS_Stream::fill_buff", "buff"); 
+    buff_size = _buff.size() - 1; 
+  }
+  int len = file->readBytes_upTo(buff+buff_end, buff_size-buff_end); 
+  if (len <= 0) {
+    isEof = true; 
+    return false; 
+  }
+  buff_end += len; 
+  return true; 
+}
+
+/*------------------------------------------------------------------*/
+int AzSvDataS_Stream::read_text(int max_num, 
+                                AzSmat *m_feat)
+{
+  const char *eyec = "AzSvDataS_Stream::read_text"; 
+  if (_line_offs.size() < max_num+1) {
+    _line_offs.free(&line_offs); 
+    _line_offs.alloc(&line_offs, max_num+1, eyec, "line_offs"); 
+  }
+
+  /*---  find lines; the offsets are relative to buff_beg  ---*/
+  line_offs[0] = 0; 
+  int num = 0, pos = 0; 
+  while (num < max_num) {
+    const AzByte *bp = buff + buff_beg + pos; 
+    int rem = buff_end - buff_beg - pos; 
+    const AzByte *nl = (rem > 0) ? (const AzByte *)memchr(bp, '\n', rem) : NULL; 
+    if (nl != NULL) {
+      pos += (int)(nl - bp) + 1; 
+      line_offs[++num] = pos; 
+      continue; 
+    }
+    if (fill_buff()) continue; 
+
+    /*---  end of file  ---*/
+    if (rem > 0) { /* the last line without a new line */
+      pos += rem; 
+      line_offs[++num] = pos; 
+    }
+    break; 
+  }
+  buff[buff_end] = '\0';  /* to make the last line a C string */
+
+  if (num <= 0) {
+    m_feat->reform(f_num, 0); 
+    return 0; 
+  }
+
+  AzSvDataS_Packer packer(num); 
+  AzSvDataS_ParseTask task; 
+  task.block = buff + buff_beg; 
+  task.line_offs = line_offs; 
+  task.line_num = num; 
+  task.lines_per_task = MAX(1, MIN(1024, num/(threads.threadNum()*4))); 
+  task.f_num = f_num; 
+  task.isSparse = isSparse; 
+  task.data_fn = s_fn.c_str(); 
+  task.first_line_no = line_no; 
+  task.first_dx = 0; 
+  task.parsed = packer.new_parsed(task.taskNum()); 
+  task.elm_num = packer.elm_num(); 
+  threads.run(&task, task.taskNum()); 
+  packer.pack(f_num, m_feat); 
+
+  buff_beg += pos; 
+  line_no += num; 
+  data_no += num; 
+  return num; 
+}
+
+/*------------------------------------------------------------------*/
+void AzSvDataS_Stream::open_binary(int expected_f_num)
+{
+  const char *eyec = "AzSvDataS_Stream::open_binary"; 
+  const char *fn = s_fn.c_str(); 
+  AZint8 file_size = file->size(); 
+  char magic[AzSvDataS_BinaryMagicLen]; 
+  file->seekReadBytes(0, AzSvDataS_BinaryMagicLen, magic); 
+  if (memcmp(magic, AzSvDataS_BinaryMagic, AzSvDataS_BinaryMagicLen) != 0) {
+    throw new AzException(AzInputNotValid, eyec, "Not a binary data file: ", fn); 
+  }
+  file->checkBinMarker(); 
+  f_num = file->readInt(); 
+  bin_data_num = file->readInt(); 
+  bin_nz_num = file->readInt8(); 
+  if (f_num <= 0 || bin_data_num <= 0 || bin_nz_num < 0) {
+    throw new AzException(AzInputNotValid, eyec, "Broken header: ", fn); 
+  }
+  if (expected_f_num > 0 && f_num != expected_f_num) {
+    AzBytArr s("Expected "); s.cn(expected_f_num); s.c(" features but found "); 
+    s.cn(f_num); s.c(": "); s.c(fn); 
+    throw new AzException(AzInputNotValid, eyec, s.c_str()); 
+  }
+  bin_colptr_offs = AzSvDataS_BinaryMagicLen + sizeof(int)+sizeof(double) /* marker */
+                  + sizeof(int)*2 + sizeof(AZint8); 
+  bin_pos = bin_colptr_offs + (AZint8)sizeof(AZint8)*(bin_data_num+1); 
+  if (file_size != bin_pos + (AZint8)(sizeof(int)+sizeof(double))*bin_nz_num) {
+    throw new AzException(AzInputNotValid, eyec, "Broken or truncated file: ", fn); 
+  }
+  bin_nz_done = 0; 
+}
+
+/*------------------------------------------------------------------*/
+int AzSvDataS_Stream::read_binary(int max_num, 
+                                  AzSmat *m_feat)
+{
+  const char *eyec = "AzSvDataS_Stream::read_binary"; 
+  int num = MIN(max_num, bin_data_num - data_no); 
+  if (num <= 0) {
+    m_feat->reform(f_num, 0); 
+    return 0; 
+  }
+
+  /*---  offsets of the columns to be read  ---*/
+  AzBaseArray<AZint8> _colptr; 
+  AZint8 *colptr = NULL; 
+  _colptr.alloc(&colptr, num+1, eyec, "colptr"); 
+  file->seekReadBytes(bin_colptr_offs + (AZint8)sizeof(AZint8)*data_no, 
+                      (AZint8)sizeof(AZint8)*(num+1), colptr); 
+  int dx; 
+  for (dx = 0; dx <= num; ++dx) {
+    AzFile::swap_int8(&colptr[dx]); 
+    if (dx > 0) {
+      AZint8 nz = colptr[dx] - colptr[dx-1]; 
+      if (nz < 0 || nz > f_num) {
+        throw new AzException(AzInputNotValid, eyec, "Broken column offsets: ", s_fn.c_str()); 
+      }
+    }
+  }
+  if (colptr[0] != bin_nz_done || colptr[num] > bin_nz_num) {
+    throw new AzException(AzInputNotValid, eyec, "Broken column offsets: ", s_fn.c_str()); 
+  }
+  AZint8 nz_done = colptr[0]; 
+  for (dx = 0; dx <= num; ++dx) colptr[dx] -= nz_done; 
+
+  /*---  read the columns directly into packed storage  ---*/
+  AZI_VECT_ELM *elm = m_feat->reform_packed(f_num, num, colptr); 
+  AzIntArr ia_row; 
+  ia_row.reset(f_num, 0); 
+  int *row = ia_row.point_u(); 
+  AzDvect v_val(f_num); 
+  double *val = v_val.point_u(); 
+  file->seek(bin_pos); 
+  for (dx = 0; dx < num; ++dx) {
+    int nz = (int)(colptr[dx+1] - colptr[dx]); 
+    if (nz == 0) continue; 
+    file->readBytes(row, (AZint8)sizeof(int)*nz); 
+    file->readBytes(val, (AZint8)sizeof(double)*nz); 
+    AZI_VECT_ELM *out = elm + colptr[dx]; 
+    int ix; 
+    for (ix = 0; ix < nz; ++ix) {
+      AzFile::swap_int4(&row[ix]); 
+      AzFile::swap_double(&val[ix]); 
+      if (row[ix] < 0 || row[ix] >= f_num || (ix > 0 && row[ix] <= row[ix-1])) {
+        throw new AzException(AzInputNotValid, eyec, "Broken row#: ", s_fn.c_str()); 
+      }
+      out[ix].no = row[ix]; 
+      out[ix].val = (AZ_MTX_FLOAT)val[ix]; 
+    }
+  }
+  bin_pos += (AZint8)(sizeof(int)+sizeof(double))*colptr[num]; 
+  bin_nz_done = nz_done + colptr[num]; 
+  data_no += num; 
+  return num; 
+}
@@ -24,6 +24,7 @@
 #include "AzDmat.hpp"
 #include "AzStrPool.hpp"
 #include "AzSvFeatInfo.hpp"
+#include "AzThreads.hpp"
 
 /* S for separation of features and targets */
 class AzSvDataS : public virtual AzSvFeatInfo /* feature template */
@@ -34,9 +35,16 @@ protected:
   AzDvect v_y; 
   int max_data_num; 
   double const_to_add; 
+  int thread_num; /* for parsing text */
   
 public: 
-  AzSvDataS() : max_data_num(-1), const_to_add(0) {}
+  friend class AzSvDataS_ParseTask; 
+  friend class AzSvDataS_Stream; 
+  AzSvDataS() : max_data_num(-1), const_to_add(0), thread_num(1) {}
+  /*---  num<=0: use all the cores  ---*/
+  inline void set_thread_num(int num) {
+    thread_num = num; 
+  }
   inline const AzSmat *feat() const {
     checkIfReady("feat"); 
     return &m_feat; 
@@ -253,6 +261,18 @@ public:
     v_sdev->reform(m->rowNum()); 
     AzDvect::sdev(&v_avg, &v_avg2, v_sdev); 
   }  
+
+  /*---  write a binary data file, which can be read faster than text  ---*/
+  static void writeData_Binary(const char *data_fn, 
+                               const AzSmat *m_data); 
+
+  /*---  parse data lines given one by one instead of in a file  ---*/
+  /*---  f_num<=0 (dense only): #value of the first line         ---*/
+  static void parseLines(const AzStrPool *sp_lines, 
+                         int f_num, 
+                         bool isSparse, 
+                         /*---  output  ---*/
+                         AzSmat *m_feat); 
   
 protected:
   virtual void _read(const char *feat_fn, 
@@ -267,18 +287,33 @@ protected:
                           /*---  output  ---*/
                           AzSmat *m_feat, 
                           AzStrPool *sp_f_dic, 
-                          int max_data_num=-1); 
+                          int max_data_num=-1, 
+                          int thread_num=1); 
   static void read_target(const char *y_fn, 
                           AzDvect *v_y,
-                          int max_data_num=-1); 
+                          int max_data_num=-1, 
+                          int thread_num=1); 
 
   static void readData(const char *data_fn, 
                          int expected_f_num, 
                          /*---  output  ---*/
                          AzSmat *m_data,
-                         int max_data_num=-1) {                      
-    readData_Large(data_fn, expected_f_num, m_data, max_data_num);   /* 12/16/2012 */
+                         int max_data_num=-1, 
+                         int thread_num=1) {                      
+    if (isBinary(data_fn)) {
+      readData_Binary(data_fn, expected_f_num, m_data, max_data_num); 
+      return; 
+    }
+    readData_Large(data_fn, expected_f_num, m_data, max_data_num, thread_num);   /* 12/16/2012 */
   }
+
+  /*---  binary data file (made by "convert") to skip parsing text  ---*/
+  static bool isBinary(const char *data_fn); 
+  static void readData_Binary(const char *data_fn, 
+                         int expected_f_num, 
+                         /*---  output  ---*/
+                         AzSmat *m_data, 
+                         int max_data_num=-1); 
 #if 0   
   static void readData_Small(const char *data_fn, 
                          int expected_f_num, 
@@ -290,7 +325,8 @@ protected:
                          /*---  output  ---*/
                          AzSmat *m_feat, 
                          /*---  ---*/
-                         int max_data_num=-1); 
+                         int max_data_num=-1, 
+                         int thread_num=1); 
 
   inline static void parseDataLine(const AzByte *inp, 
                               int inp_len, 
@@ -352,13 +388,16 @@ protected:
                            int line_no) {
     if (*str == '\0' || *str >= '0' && *str <= '9' || 
         *str == '+' || *str == '-') {
-      return atof(str); 
+      return parse_double(str); 
     }
     AzBytArr s("Invalid number expression in line# ");
     s.cn(line_no); s.c(" of the input data file: "); s.c(str); 
     throw new AzException(AzInputError, eyec, s.c_str()); 
   }
 
+  /*---  same as atof; faster on plain decimals such as "-12.5" and "3e-4"  ---*/
+  static double parse_double(const char *str); 
+
   inline static int my_fno(const char *str, 
                            const char *eyec, 
                            int line_no) {
@@ -372,4 +411,69 @@ protected:
   }
 }; 
 
+//! Read a data file a block of data points at a time.  
+/**
+  *  Memory usage is proportional to the block size, not the file size.  
+  *  Text (dense or sparse) and binary (made by "convert") files are accepted.  
+ **/
+class AzSvDataS_Stream {
+protected:
+  AzBytArr s_fn; 
+  AzFile *file; 
+  bool isBinary, isSparse; 
+  int f_num; 
+  int line_no;  /* text: #line consumed */
+  int data_no;  /* #data read */
+
+  /*---  text  ---*/
+  AzBaseArray<AzByte> _buff; 
+  AzByte *buff; 
+  int buff_beg, buff_end; 
+  bool isEof; 
+  AzBaseArray<AZint8> _line_offs; 
+  AZint8 *line_offs; 
+  AzThreads threads; 
+
+  /*---  binary  ---*/
+  int bin_data_num; 
+  AZint8 bin_nz_num, bin_colptr_offs, bin_pos, bin_nz_done; 
+
+  static const int buff_size_init = 1024*1024; 
+
+public:
+  AzSvDataS_Stream() : file(NULL), isBinary(false), isSparse(false), f_num(0), 
+                       line_no(0), data_no(0), buff(NULL), buff_beg(0), buff_end(0), 
+                       isEof(false), line_offs(NULL), bin_data_num(0), 
+                       bin_nz_num(0), bin_colptr_offs(0), bin_pos(0), bin_nz_done(0) {}
+  ~AzSvDataS_Stream() {
+    close(); 
+  }
+  void open(const char *fn, 
+            int expected_f_num=-1, 
+            int thread_num=1); /* for parsing text */
+  void close() {
+    if (file != NULL) {
+      file->close(); 
+      delete file; file = NULL; 
+    }
+  }
+  inline int featNum() const { return f_num; }
+  inline int dataNum() const { return (isBinary) ? bin_data_num : -1; } /* -1: unknown */
+  inline int dataNum_done() const { return data_no; }
+
+  /*---  read at most max_num data points; returns #data read, which is 0 at the end  ---*/
+  int read(int max_num, 
+           AzSmat *m_feat); /* output: #feat x #data */
+
+protected:
+  int read_text(int max_num, AzSmat *m_feat); 
+  int read_binary(int max_num, AzSmat *m_feat); 
+  void open_binary(int expected_f_num); 
+  bool fill_buff(); /* returns false at the end of file */
+
+  /*---  prohibit copying  ---*/
+  AzSvDataS_Stream(const AzSvDataS_Stream &); 
+  AzSvDataS_Stream & operator =(const AzSvDataS_Stream &); 
+}; 
+
 #endif 
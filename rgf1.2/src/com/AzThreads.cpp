@@ -0,0 +1,172 @@
+/* * * * *
+ *  AzThreads.cpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#include "AzThreads.hpp"
+
+#ifdef _AZ_SINGLE_THREAD_
+/*--------------------------------------------------------*/
+void AzThreads::reset(int num)
+{
+  thread_num = 1; 
+}
+
+/*--------------------------------------------------------*/
+void AzThreads::stop()
+{
+  thread_num = 1; 
+}
+
+/*--------------------------------------------------------*/
+void AzThreads::run(AzThreadTask *inp_task, int inp_task_num)
+{
+  int tx; 
+  for (tx = 0; tx < inp_task_num; ++tx) {
+    inp_task->run(tx, 0); 
+  }
+}
+
+#else
+/*--------------------------------------------------------*/
+void AzThreads::reset(int num)
+{
+  stop(); 
+  if (num <= 0) num = coreNum(); 
+  thread_num = num; 
+  doQuit = false; 
+  generation = 0; 
+  int thread_no; 
+  for (thread_no = 1; thread_no < thread_num; ++thread_no) {
+    workers.push_back(std::thread(&AzThreads::work, this, thread_no)); 
+  }
+}
+
+/*--------------------------------------------------------*/
+void AzThreads::stop()
+{
+  if (workers.size() > 0) {
+    {
+      std::lock_guard<std::mutex> lock(mtx); 
+      doQuit = true; 
+    }
+    cv_start.notify_all(); 
+    int ix; 
+    for (ix = 0; ix < (int)workers.size(); ++ix) {
+      workers[ix].join(); 
+    }
+    workers.clear(); 
+  }
+  thread_num = 1; 
+}
+
+/*--------------------------------------------------------*/
+void AzThreads::run(AzThreadTask *inp_task, int inp_task_num)
+{
+  if (inp_task_num <= 0) return; 
+
+  bool wasBusy = isBusy.exchange(true); 
+  if (wasBusy || thread_num <= 1 || inp_task_num == 1) {
+    /*---  serial  ---*/
+    if (!wasBusy) isBusy = false; 
+    int tx; 
+    for (tx = 0; tx < inp_task_num; ++tx) {
+      inp_task->run(tx, 0); 
+    }
+    return; 
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mtx); 
+    task = inp_task; 
+    task_num = inp_task_num; 
+    next_tx = 0; 
+    err = NULL; 
+    running_num = (int)workers.size(); 
+    ++generation; 
+  }
+  cv_start.notify_all(); 
+
+  do_tasks(0); 
+
+  AzException *my_err = NULL; 
+  {
+    std::unique_lock<std::mutex> lock(mtx); 
+    while (running_num > 0) {
+      cv_done.wait(lock); 
+    }
+    task = NULL; 
+    my_err = err; 
+    err = NULL; 
+  }
+  isBusy = false; 
+  if (my_err != NULL) {
+    throw my_err; 
+  }
+}
+
+/*--------------------------------------------------------*/
+void AzThreads::do_tasks(int thread_no)
+{
+  try {
+    for ( ; ; ) {
+      int tx = next_tx++; 
+      if (tx >= task_num) break; 
+      task->run(tx, thread_no); 
+    }
+  }
+  catch (AzException *e) {
+    keep_error(e); 
+  }
+  catch (std::bad_alloc &) {
+    keep_error(new AzException(AzAllocError, "AzThreads::do_tasks",
+                               "Memory allocation failed in a thread")); 
+  }
+}
+
+/*--------------------------------------------------------*/
+void AzThreads::keep_error(AzException *e)
+{
+  next_tx = task_num; /* let the others stop early */
+  std::lock_guard<std::mutex> lock(mtx); 
+  if (err == NULL) err = e; 
+  else             delete e; 
+}
+
+/*--------------------------------------------------------*/
+void AzThreads::work(int thread_no)
+{
+  int my_generation = 0; 
+  for ( ; ; ) {
+    {
+      std::unique_lock<std::mutex> lock(mtx); 
+      while (!doQuit && generation == my_generation) {
+        cv_start.wait(lock); 
+      }
+      if (doQuit) return; 
+      my_generation = generation; 
+    }
+
+    do_tasks(thread_no); 
+
+    {
+      std::lock_guard<std::mutex> lock(mtx); 
+      --running_num; 
+    }
+    cv_done.notify_one(); 
+  }
+}
+#endif
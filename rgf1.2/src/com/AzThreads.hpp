@@ -0,0 +1,110 @@
+/* * * * *
+ *  AzThreads.hpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#ifndef _AZ_THREADS_HPP_
+#define _AZ_THREADS_HPP_
+
+#include "AzUtil.hpp"
+
+/*---  Visual C++ 2010 (proj_vc2010) has no <thread>; run one thread there  ---*/
+#if defined(_MSC_VER) && _MSC_VER < 1700
+#define _AZ_SINGLE_THREAD_
+#else
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#endif
+
+//! Interface: a batch of independent tasks to be run by AzThreads.
+class AzThreadTask {
+public:
+  /*---  tx: task#, thread_no: 0..threadNum()-1; thread 0 is the caller  ---*/
+  virtual void run(int tx, int thread_no) = 0; 
+}; 
+
+//! Persistent pool of worker threads.
+/**
+  *  run() hands out task numbers 0..task_num-1 one at a time to whichever
+  *  thread is free, and returns when all the tasks are done.  The caller
+  *  works as thread#0.  A nested call (from within a task) or a call with
+  *  one thread runs the tasks in order on the calling thread.
+  *  An AzException thrown in a task is re-thrown to the caller.
+  *  Without C++11 threads (_AZ_SINGLE_THREAD_), it always runs one thread.
+ **/
+class AzThreads {
+protected:
+  int thread_num; 
+#ifndef _AZ_SINGLE_THREAD_
+  std::vector<std::thread> workers; 
+
+  std::mutex mtx; 
+  std::condition_variable cv_start, cv_done; 
+  AzThreadTask *task; 
+  int task_num; 
+  std::atomic<int> next_tx; 
+  int generation; 
+  int running_num; 
+  bool doQuit; 
+  std::atomic<bool> isBusy; 
+  AzException *err; 
+#endif
+
+public:
+#ifndef _AZ_SINGLE_THREAD_
+  AzThreads() : thread_num(1), task(NULL), task_num(0), next_tx(0),
+                generation(0), running_num(0), doQuit(false),
+                isBusy(false), err(NULL) {}
+#else
+  AzThreads() : thread_num(1) {}
+#endif
+  ~AzThreads() {
+    stop(); 
+  }
+
+  /*---  num<=0: use all the cores  ---*/
+  void reset(int num); 
+  inline int threadNum() const {
+    return thread_num; 
+  }
+  void run(AzThreadTask *task, int task_num); 
+
+  static int coreNum() {
+#ifndef _AZ_SINGLE_THREAD_
+    int num = (int)std::thread::hardware_concurrency(); 
+    return MAX(num, 1); 
+#else
+    return 1; 
+#endif
+  }
+
+protected:
+  void stop(); 
+#ifndef _AZ_SINGLE_THREAD_
+  void work(int thread_no); 
+  void do_tasks(int thread_no); 
+  void keep_error(AzException *e); 
+#endif
+
+  /*---  prohibit copying  ---*/
+  AzThreads(const AzThreads &); 
+  AzThreads & operator =(const AzThreads &); 
+}; 
+
+#endif
@@ -191,6 +191,10 @@ public:
   inline void readBytes(void *buff, AZint8 len) {
     seekReadBytes(-1, len, buff); 
   }
+  /*---  returns the number of bytes read, which is 0 at the end of file  ---*/
+  inline int readBytes_upTo(AzByte *buff, int len) {
+    return _readBytes(buff, len); 
+  }
   template <class T> 
   void readItems(T *data, int num) {
     const char *eyec = "AzFile::readItems"; 
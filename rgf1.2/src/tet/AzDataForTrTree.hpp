@@ -23,11 +23,28 @@
 #include "AzSmat.hpp"
 #include "AzSvFeatInfoClone.hpp"
 #include "AzSortedFeat.hpp"
+#include "AzHistBins.hpp"
 #include "AzParam.hpp"
 #include "AzHelp.hpp"
+#include "AzThreads.hpp"
+#include <time.h>
+
+#if defined(_WIN32)
+#include <process.h>
+#define Az_getpid _getpid
+#else
+#include <unistd.h>
+#define Az_getpid getpid
+#endif
 
 #define kw_dataproc  "data_management="
-#define help_dataproc "Sparse|Dense|Auto.  Data is treated either as \"Sparse\" data (having many zeroes), as \"Dense\" data, or as \"Auto\"matically determined.  It affects speed and memory consumption of training."
+#define help_dataproc "Sparse|Dense|Auto.  Data is treated either as \"Sparse\" data (having many zeroes), as \"Dense\" data, or as \"Auto\"matically determined for each feature by its nonzero ratio, so that dense and sparse features can be mixed.  It affects speed and memory consumption of training."
+#define kw_split_mode "split_mode="
+#define help_split_mode "Sorted|Histogram.  \"Sorted\": node split search goes through the data points sorted by feature values.  \"Histogram\": training data is kept only as bin numbers of feature values quantized into at most max_bin bins, and node split search goes through the bins; faster and smaller on large data, but split points are restricted to the bin borders.  It uses one byte (max_bin<=255) or two bytes per data point per feature."
+#define kw_max_bin "max_bin="
+#define help_max_bin "Maximum number of bins per feature for split_mode=Histogram (2..65535).  Features with no more distinct values than this are kept without loss."
+#define kw_presort_cache "presort_cache="
+#define help_presort_cache "Path prefix of the files to keep the training data points sorted by feature values.  The file name is this value followed by a hash of training data.  If the file exists, it is read instead of sorting; otherwise it is written for later runs on the same training data (e.g., with different regularization parameters).  Not used with split_mode=Histogram."
 
 /*--------------------------------------------------------*/
 class AzDataForTrTree {
@@ -43,9 +60,12 @@ protected:
    *  Faster than safer design through abstraction.  
    */
   /*-------------------------*/
+  AzIntArr ia_fx2dense; /* set only when dense and sparse features are mixed: */
+                        /* column# of m_tran_dense, or -1 for m_tran_sparse   */
 
   AzSvFeatInfoClone feat; 
-  AzSortedFeatArr sorted_arr;  /* not set if this is test data */
+  AzSortedFeatArr sorted_arr;  /* not set if this is test data or with histograms */
+  AzHistBins hist_bins;        /* set only with histograms */
 
   enum dataproc_Type {
     dataproc_Auto = 0, 
@@ -55,16 +75,23 @@ protected:
 
   #define Az_nz_ratio_threshold 0.4
   #define Az_max_test_entries (1024*1024*16)
+  #define Az_presort_cache_version 2 /* change it when the file layout changes */
   dataproc_Type dataproc; 
   AzBytArr s_dataproc; 
+  bool doHistogram; 
+  AzBytArr s_split_mode; 
+  int max_bin; 
+  AzBytArr s_presort_cache; 
 
 public:
-  AzDataForTrTree() : dataproc(dataproc_Auto), data_num(0) {}
+  AzDataForTrTree() : dataproc(dataproc_Auto), data_num(0), 
+                      doHistogram(false), max_bin(AzHistBins::max_bin_byte) {}
   virtual void reset_data(const AzOut &out, 
                   const AzSmat *m_data, 
                   AzParam &p, 
                   bool beTight, 
-                  const AzSvFeatInfo *inp_feat=NULL)
+                  const AzSvFeatInfo *inp_feat=NULL, 
+                  AzThreads *threads=NULL) /* for transposing data */
   {
     resetParam(p); 
     printParam(out); 
@@ -76,17 +103,22 @@ public:
     s.cn(m_data->rowNum());s.c("x");s.cn(m_data->colNum()); 
     s.c(", nonzero_ratio=", nz_ratio, 4); 
 
-    /*---  decide sparse or dense  ---*/
-    AzBytArr s_dp("; managed as dense data"); 
-    bool doSparse = false; 
-    if (dataproc == dataproc_Auto && 
-        nz_ratio < Az_nz_ratio_threshold || 
-        dataproc == dataproc_Sparse) { 
-      doSparse = true; 
-      s_dp.reset("; managed as sparse data"); 
+    /*---  decide sparse or dense for each feature  ---*/
+    int f_num = m_data->rowNum(); 
+    AzIntArr ia_dense_fxs; 
+    if      (dataproc == dataproc_Auto)  choose_dense(m_data, &ia_dense_fxs); 
+    else if (dataproc == dataproc_Dense) ia_dense_fxs.range(0, f_num); 
+    int dense_num = ia_dense_fxs.size(); 
+    AzBytArr s_dp; 
+    if      (dense_num == 0)     s_dp.reset("; managed as sparse data"); 
+    else if (dense_num == f_num) s_dp.reset("; managed as dense data"); 
+    else {
+      s_dp.reset("; "); s_dp.cn(dense_num); s_dp.c(" features managed as dense data and "); 
+      s_dp.cn(f_num-dense_num); s_dp.c(" as sparse data"); 
     }
     if (dataproc != dataproc_Auto) s_dp.concat(" as requested."); 
     else                           s_dp.concat("."); 
+    if (doHistogram) s_dp.reset("; kept as bins of feature values."); 
     AzPrint::writeln(out, "-------------"); 
     AzPrint::writeln(out, s, s_dp); 
     AzPrint::writeln(out, "-------------"); 
@@ -95,14 +127,33 @@ public:
     m_tran_sparse.reset(); 
     m_tran_dense.unlock(); 
     m_tran_dense.reset(); 
+    ia_fx2dense.reset(); 
+    sorted_arr.reset(); 
+    hist_bins.reset(); 
     data_num = m_data->colNum(); 
-    if (doSparse) {
-      m_data->transpose(&m_tran_sparse); 
-      sorted_arr.reset_sparse(&m_tran_sparse, beTight); 
+    if (doHistogram) {
+      /*---  keep only the bins; the transpose is temporary  ---*/
+      AzSmat m_tran; 
+      m_data->transpose(&m_tran, -1, -1, threads); 
+      hist_bins.reset(&m_tran, max_bin); 
+      AzBytArr s_bin("Binned training data: "); 
+      s_bin.cn(hist_bins.size()/1024/1024, 3); s_bin.c(" MB"); 
+      AzPrint::writeln(out, s_bin); 
+    }
+    else if (dense_num == 0) {
+      m_data->transpose(&m_tran_sparse, -1, -1, threads); 
+      reset_sorted(out, m_data, beTight); 
     }
     else {
-      m_tran_dense.transpose_from(m_data); 
-      sorted_arr.reset_dense(&m_tran_dense, beTight); 
+      if (dense_num == f_num) {
+        m_tran_dense.transpose_from(m_data, threads); 
+      }
+      else {
+        AzSmat m_tran; 
+        m_data->transpose(&m_tran, -1, -1, threads); 
+        set_mixed(&m_tran, &ia_dense_fxs); 
+      }
+      reset_sorted(out, m_data, beTight); 
       /* prohibit any action to change the pointers to the column vectors */
       m_tran_dense.lock(); 
     }
@@ -118,7 +169,8 @@ public:
   }
 
   virtual void reset_data_for_test(const AzOut &out, 
-                     const AzSmat *m_data) {
+                     const AzSmat *m_data, 
+                     AzThreads *threads=NULL) { /* for transposing data */
     bool doSparse = false; 
     if (m_data->rowNum()*m_data->colNum() > Az_max_test_entries) { /* large data */
       /*---  dense is faster but uses up more memory if data is sparse  ---*/
@@ -135,13 +187,15 @@ public:
     data_num = m_data->colNum(); 
     m_tran_dense.reset(); 
     m_tran_sparse.reset(); 
+    ia_fx2dense.reset(); 
     if (doSparse) {    
-      m_data->transpose(&m_tran_sparse); 
+      m_data->transpose(&m_tran_sparse, -1, -1, threads); 
     }
     else {
-      m_tran_dense.transpose_from(m_data); 
+      m_tran_dense.transpose_from(m_data, threads); 
     }
     sorted_arr.reset(); 
+    hist_bins.reset(); 
     feat.reset(m_data->rowNum()); 
   }
 
@@ -156,10 +210,16 @@ public:
               int fx, 
               double border_val) const
   {
+    if (!hist_bins.isEmpty()) {
+      return hist_bins.isLE(dx, fx, border_val); 
+    }
     double value; 
     if (AzSmat::isNull(&m_tran_sparse)) {
       value = m_tran_dense.get(dx, fx); 
     }
+    else if (ia_fx2dense.size() > 0 && ia_fx2dense.get(fx) >= 0) {
+      value = m_tran_dense.get(dx, ia_fx2dense.get(fx)); 
+    }
     else {
       value = m_tran_sparse.get(dx, fx); 
     }
@@ -178,13 +238,202 @@ public:
     return sorted_arr.sorted(fx); 
   }
 
+  /*---  NULL unless split_mode=Histogram  ---*/
+  virtual inline const AzHistBins *histBins() const {
+    if (hist_bins.isEmpty()) return NULL; 
+    return &hist_bins; 
+  }
+  /*---  separate data points by a feature value without sorted arrays  ---*/
+  virtual void getIndexes(int fx, 
+                          const int *dxs, int dxs_num, 
+                          double border_val, 
+                          /*---  output  ---*/
+                          AzIntArr *ia_le_dx, 
+                          AzIntArr *ia_gt_dx) const 
+  {
+    ia_le_dx->reset(); 
+    ia_gt_dx->reset(); 
+    int ix; 
+    if (!hist_bins.isEmpty()) {
+      int le_bx = hist_bins.leBin(fx, border_val); 
+      for (ix = 0; ix < dxs_num; ++ix) {
+        int dx = dxs[ix]; 
+        if (hist_bins.binCode(dx, fx) <= le_bx) ia_le_dx->put(dx); 
+        else                                   ia_gt_dx->put(dx); 
+      }
+    }
+    else {
+      for (ix = 0; ix < dxs_num; ++ix) {
+        int dx = dxs[ix]; 
+        if (isLE(dx, fx, border_val)) ia_le_dx->put(dx); 
+        else                          ia_gt_dx->put(dx); 
+      }
+    }
+  }
+
   /*------------------------------------------------*/
   virtual void printHelp(AzHelp &h) const {
     h.begin("", "AzDataForTrTree", "Data processing"); 
     h.item(kw_dataproc, help_dataproc, "Auto"); 
+    h.item(kw_split_mode, help_split_mode, "Sorted"); 
+    h.item(kw_max_bin, help_max_bin, AzHistBins::max_bin_byte); 
+    h.item(kw_presort_cache, help_presort_cache); 
   }
 
 protected: 
+  /*---  dense if its nonzero ratio is no smaller than the threshold  ---*/
+  /*
+   *  Split search and separation of a node go through all the data points 
+   *  for a dense feature, and only the nonzero ones for a sparse feature, 
+   *  but the latter costs more per data point (values kept with indexes, 
+   *  zeroes handled separately, new arrays for each node), about 
+   *  1/Az_nz_ratio_threshold times as much.  
+   *  The two add up the statistics of the data points in different orders, 
+   *  so a feature that was managed the other way when the whole data was 
+   *  either dense or sparse can make the model differ in the last bits.  
+   */
+  static void choose_dense(const AzSmat *m_data, 
+                           AzIntArr *ia_dense_fxs) /* output */
+  {
+    ia_dense_fxs->reset(); 
+    AzIntArr ia_nz(m_data->rowNum(), 0); 
+    int *nz = ia_nz.point_u(); 
+    int dx; 
+    for (dx = 0; dx < m_data->colNum(); ++dx) {
+      const AzSvect *v = m_data->col(dx); 
+      AzCursor cur; 
+      for ( ; ; ) {
+        double val; 
+        int fx = v->next(cur, val); 
+        if (fx < 0) break; 
+        ++nz[fx]; 
+      }
+    }
+    double min_nz = m_data->colNum()*Az_nz_ratio_threshold; 
+    int fx; 
+    for (fx = 0; fx < ia_nz.size(); ++fx) {
+      if (nz[fx] > 0 && nz[fx] >= min_nz) ia_dense_fxs->put(fx); 
+    }
+  }
+
+  /*---  dense features to columns of m_tran_dense, the rest to m_tran_sparse  ---*/
+  void set_mixed(const AzSmat *m_tran, 
+                 const AzIntArr *ia_dense_fxs) 
+  {
+    int f_num = m_tran->colNum(); 
+    ia_fx2dense.reset(f_num, -1); 
+    int *fx2dense = ia_fx2dense.point_u(); 
+    AzIntArr ia_cols; /* new2old; -1 to leave it empty */
+    ia_cols.range(0, f_num); 
+    int *cols = ia_cols.point_u(); 
+    m_tran_dense.reform(m_tran->rowNum(), ia_dense_fxs->size()); 
+    int ix; 
+    for (ix = 0; ix < ia_dense_fxs->size(); ++ix) {
+      int fx = ia_dense_fxs->get(ix); 
+      fx2dense[fx] = ix; 
+      cols[fx] = -1; 
+      m_tran_dense.col_u(ix)->set(m_tran->col(fx)); 
+    }
+    m_tran_sparse.set(m_tran, cols, f_num, true); 
+  }
+
+  /*---  sort the data points, or read them sorted from the cache  ---*/
+  virtual void reset_sorted(const AzOut &out, 
+                            const AzSmat *m_data, 
+                            bool beTight) 
+  {
+    const char *eyec = "AzDataForTrTree::reset_sorted"; 
+    const AzSmat *m_sparse = &m_tran_sparse; 
+    const AzDmat *m_dense = &m_tran_dense; 
+    AzIntArr ia_fx2d; 
+    const char *type = ".mixed"; 
+    if (ia_fx2dense.size() > 0) {
+      ia_fx2d.reset(&ia_fx2dense); 
+    }
+    else if (AzSmat::isNull(&m_tran_sparse)) {
+      ia_fx2d.range(0, m_tran_dense.colNum()); 
+      m_sparse = NULL; 
+      type = ".dense"; 
+    }
+    else {
+      ia_fx2d.reset(m_tran_sparse.colNum(), -1); 
+      m_dense = NULL; 
+      type = ".sparse"; 
+    }
+
+    if (s_presort_cache.length() <= 0) {
+      sorted_arr.reset(m_sparse, m_dense, &ia_fx2d, beTight); 
+      return; 
+    }
+
+    AZint8 hash = m_data->hash(); 
+    AzBytArr s_fn(&s_presort_cache); 
+    int bx; 
+    for (bx = 60; bx >= 0; bx -= 4) {
+      s_fn.c((AzByte)"0123456789abcdef"[(hash >> bx) & 0xf]); 
+    }
+    s_fn.c(type); 
+
+    /*---  a file that can't be used (broken, old, or for other data) is a miss  ---*/
+    if (AzFile::isExisting(s_fn.c_str())) {
+      try {
+        AzFile file(s_fn.c_str()); 
+        file.open("rb"); 
+        file.checkBinMarker(); 
+        int file_version = file.readInt(); 
+        AZint8 file_hash = file.readInt8(); 
+        int file_data_num = file.readInt(); 
+        if (file_version != Az_presort_cache_version) {
+          throw new AzException(AzInputError, eyec, "Version mismatch: ", s_fn.c_str()); 
+        }
+        if (file_hash != hash || file_data_num != m_data->colNum()) {
+          throw new AzException(AzInputError, eyec, "Presorted data does not match training data: ", 
+                                s_fn.c_str()); 
+        }
+        sorted_arr.read(&file, m_sparse, m_dense, &ia_fx2d, beTight); 
+        file.close(); 
+        AzTimeLog::print("Read presorted data from ", s_fn.c_str(), out); 
+        return; 
+      }
+      catch (AzException *e) {
+        AzTimeLog::print("Ignored presorted data: ", e->getMessage().c_str(), out); 
+        delete e; 
+        sorted_arr.reset(); 
+      }
+    }
+
+    sorted_arr.reset(m_sparse, m_dense, &ia_fx2d, beTight); 
+
+    /*---  write to a temporary file of its own and rename it so that  ---*/
+    /*---  a run in parallel never reads or writes a partial file      ---*/
+    /*---  the cache is optional; failing to write it is not an error  ---*/
+    AzBytArr s_tmp_fn(&s_fn); 
+    s_tmp_fn.c(".tmp"); s_tmp_fn.cn((AZint8)Az_getpid()); 
+    s_tmp_fn.c("_"); s_tmp_fn.cn((AZint8)time(NULL)); 
+    try {
+      AzFile file(s_tmp_fn.c_str()); 
+      file.open("wb"); 
+      file.writeBinMarker(); 
+      file.writeInt(Az_presort_cache_version); 
+      file.writeInt8(hash); 
+      file.writeInt(m_data->colNum()); 
+      sorted_arr.write(&file); 
+      file.close(true); 
+    }
+    catch (AzException *e) {
+      AzTimeLog::print("Could not write presorted data to ", s_fn.c_str(), out); 
+      AzTimeLog::print("  ", e->getMessage().c_str(), out); 
+      delete e; 
+      remove(s_tmp_fn.c_str()); 
+      return; 
+    }
+    if (rename(s_tmp_fn.c_str(), s_fn.c_str()) != 0) {
+      remove(s_tmp_fn.c_str()); /* someone else has written it */
+      return; 
+    }
+    AzTimeLog::print("Wrote presorted data to ", s_fn.c_str(), out); 
+  }
+
   /*---  for parameters  ---*/
   virtual void resetParam(AzParam &p) {
     p.vStr(kw_dataproc, &s_dataproc); 
@@ -197,13 +446,34 @@ protected:
       throw new AzException(AzInputNotValid, kw_dataproc, 
             "must be either \"Auto\", \"Sparse\", or \"Dense\"."); 
     }
+
+    p.vStr(kw_split_mode, &s_split_mode); 
+    doHistogram = false; 
+    if (s_split_mode.length() <= 0 || 
+        s_split_mode.compare("Sorted") == 0); 
+    else if (s_split_mode.compare("Histogram") == 0) doHistogram = true; 
+    else {
+      throw new AzException(AzInputNotValid, kw_split_mode, 
+            "must be either \"Sorted\" or \"Histogram\"."); 
+    }
+    p.vInt(kw_max_bin, &max_bin); 
+    if (max_bin < 2 || max_bin > AzHistBins::max_bin_max) {
+      throw new AzException(AzInputNotValid, kw_max_bin, 
+            "must be between 2 and 65535."); 
+    }
+    p.vStr(kw_presort_cache, &s_presort_cache); 
   }
   virtual void printParam(const AzOut &out) const {
     if (out.isNull()) return; 
     AzPrint o(out); 
-    if (s_dataproc.length() > 0) {
+    if (s_dataproc.length() > 0 || doHistogram || s_presort_cache.length() > 0) {
       o.ppBegin("AzDataForTrTree", "Data processing"); 
-      o.printV(kw_dataproc, s_dataproc); 
+      o.printV_if_not_empty(kw_dataproc, s_dataproc); 
+      o.printV_if_not_empty(kw_presort_cache, s_presort_cache); 
+      if (doHistogram) {
+        o.printV(kw_split_mode, s_split_mode); 
+        o.printV(kw_max_bin, max_bin); 
+      }
       o.ppEnd(); 
     }
   }
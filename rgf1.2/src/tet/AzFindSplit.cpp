@@ -18,18 +18,88 @@
 
 #include "AzFindSplit.hpp"
 
+/*--------------------------------------------------------*/
+/* T: double, or float with single precision              */
+template <class T>
+static inline void _sum_move(const int *index, int index_num, 
+                             const T *tarDw, const T *dw, 
+                             double *wy_sum, double *w_sum)
+{
+  double wy = 0, w = 0; 
+  int ix; 
+  for (ix = 0; ix < index_num; ++ix) {
+    int dx = index[ix]; 
+    wy += tarDw[dx]; 
+    w += dw[dx]; 
+  }
+  *wy_sum = wy; 
+  *w_sum = w; 
+}
+
+/*--------------------------------------------------------*/
+template <class T, class C>
+static inline void _make_hist(const int *dxs, int total_size, 
+                              const C *codes, 
+                              const T *tarDw, const T *dw, 
+                              double *wy_hist, double *w_hist, int *num_hist)
+{
+  int ix; 
+  for (ix = 0; ix < total_size; ++ix) {
+    int dx = dxs[ix]; 
+    int my_bx = codes[dx]; 
+    wy_hist[my_bx] += tarDw[dx]; 
+    w_hist[my_bx] += dw[dx]; 
+    ++num_hist[my_bx]; 
+  }
+}
+
 /*--------------------------------------------------------*/
 void AzFindSplit::_begin(const AzTrTree_ReadOnly *inp_tree, 
                          const AzDataForTrTree *inp_data, 
                          const AzTrTtarget *inp_target, 
-                         int inp_min_size)
+                         int inp_min_size, 
+                         AzThreads *inp_threads)
 {
   tree = inp_tree; 
   target = inp_target; 
   min_size = inp_min_size; 
   data = inp_data; 
+  threads = inp_threads; 
 }
 
+/*--------------------------------------------------------*/
+/* Each task goes through a contiguous chunk of features  */
+/* and keeps its own best split.                          */
+/*--------------------------------------------------------*/
+class AzFindSplit_Task : public virtual AzThreadTask {
+protected:
+  AzFindSplit *fs; 
+  const AzSortedFeatArr *sorted_arr; 
+  const int *fxs; 
+  int feat_num, chunk_size; 
+  const int *dxs; 
+  int dxs_num; 
+  const Az_forFindSplit *total; 
+  AzTrTsplit *chunk_best; 
+public:
+  AzFindSplit_Task(AzFindSplit *inp_fs, 
+                   const AzSortedFeatArr *inp_sorted_arr, 
+                   const int *inp_fxs, int inp_feat_num, int inp_chunk_size, 
+                   const int *inp_dxs, int inp_dxs_num, 
+                   const Az_forFindSplit *inp_total, 
+                   AzTrTsplit *inp_chunk_best) {
+    fs = inp_fs; sorted_arr = inp_sorted_arr; 
+    fxs = inp_fxs; feat_num = inp_feat_num; chunk_size = inp_chunk_size; 
+    dxs = inp_dxs; dxs_num = inp_dxs_num; total = inp_total; chunk_best = inp_chunk_best; 
+  }
+  void run(int tx, int thread_no) {
+    int fx_begin = tx*chunk_size; 
+    int fx_end = MIN(feat_num, fx_begin+chunk_size); 
+    fs->_findBestSplit(sorted_arr, fxs, fx_begin, fx_end, dxs, dxs_num, total, 
+                       &chunk_best[tx]); 
+  }
+}; 
+
 /*--------------------------------------------------------*/
 void AzFindSplit::_findBestSplit(int nx, 
                                  /*---  output  ---*/
@@ -44,9 +114,12 @@ void AzFindSplit::_findBestSplit(int nx,
   const int *dxs = tree->node(nx)->data_indexes(); 
   const int dxs_num = tree->node(nx)->dxs_num; 
 
-  const AzSortedFeatArr *sorted_arr = tree->sorted_array(nx, data); 
-  if (sorted_arr == NULL) {
-    throw new AzException(eyec, "No sorted array?!"); 
+  const AzSortedFeatArr *sorted_arr = NULL; 
+  if (data->histBins() == NULL) { /* histograms don't need sorted arrays */
+    sorted_arr = tree->sorted_array(nx, data); 
+    if (sorted_arr == NULL) {
+      throw new AzException(eyec, "No sorted array?!"); 
+    }
   }
 
   Az_forFindSplit total; 
@@ -59,11 +132,74 @@ void AzFindSplit::_findBestSplit(int nx,
   if (ia_fx != NULL) {
     fxs = ia_fx->point(&feat_num); 
   }
+  int chunk_num = 1; 
+  if (threads != NULL && threads->threadNum() > 1) {
+    chunk_num = MIN(feat_num, threads->threadNum()*4); 
+  }
+  if (chunk_num <= 1) {
+    _findBestSplit(sorted_arr, fxs, 0, feat_num, dxs, dxs_num, &total, best_split); 
+  }
+  else {
+    /*---  features are split into chunks; each chunk keeps its own best ---*/
+    int chunk_size = DIVUP(feat_num, chunk_num); 
+    chunk_num = DIVUP(feat_num, chunk_size); 
+    AzTrTsplit *chunk_best = NULL; 
+    AzObjArray<AzTrTsplit> a_chunk_best; 
+    a_chunk_best.alloc(&chunk_best, chunk_num, eyec, "chunk_best"); 
+    int cx; 
+    for (cx = 0; cx < chunk_num; ++cx) {
+      chunk_best[cx].copy(best_split); 
+    }
+    AzFindSplit_Task task(this, sorted_arr, fxs, feat_num, chunk_size, 
+                          dxs, dxs_num, &total, chunk_best); 
+    threads->run(&task, chunk_num); 
+
+    /*---  in the feature order, so that we get what serial search would get ---*/
+    for (cx = 0; cx < chunk_num; ++cx) {
+      const AzTrTsplit *cb = &chunk_best[cx]; 
+      if (cb->gain > best_split->gain) {
+        best_split->reset_values(cb->fx, cb->border_val, cb->gain, 
+                                 cb->bestP[0], cb->bestP[1]); 
+      }
+    }
+  }
+
+  if (best_split->fx >= 0) {
+    if (!dmp_out.isNull()) {
+      data->featInfo()->desc(best_split->fx, &best_split->str_desc); 
+    }
+  }
+}
+
+/*--------------------------------------------------------*/
+void AzFindSplit::_findBestSplit(const AzSortedFeatArr *sorted_arr, /* NULL with histograms */
+                                 const int *fxs, /* may be NULL */
+                                 int fx_begin, int fx_end, 
+                                 const int *dxs, int dxs_num, 
+                                 const Az_forFindSplit *total, 
+                                 /*---  output  ---*/
+                                 AzTrTsplit *best_split)
+{
+  const char *eyec = "AzFindSplit::_findBestSplit(features)"; 
+  const AzHistBins *bins = data->histBins(); 
+  AzDvect v_wy_hist, v_w_hist; 
+  AzIntArr ia_num_hist; 
+  if (bins != NULL) {
+    v_wy_hist.reform(bins->maxBinNum()); 
+    v_w_hist.reform(bins->maxBinNum()); 
+    ia_num_hist.reset(bins->maxBinNum(), 0); 
+  }
   int ix; 
-  for (ix = 0; ix < feat_num; ++ix) {
+  for (ix = fx_begin; ix < fx_end; ++ix) {
     int fx = ix; 
     if (fxs != NULL) fx = fxs[ix]; 
 
+    if (bins != NULL) {
+      loop_hist(best_split, fx, bins, dxs, dxs_num, total, 
+                v_wy_hist.point_u(), v_w_hist.point_u(), ia_num_hist.point_u()); 
+      continue; 
+    }
+
     AzSortedFeatWork tmp; 
     const AzSortedFeat *sorted = sorted_arr->sorted(fx); 
     if (sorted == NULL) { /* This happens only with Thrift or warm-start */
@@ -71,16 +207,82 @@ void AzFindSplit::_findBestSplit(int nx,
       if (my_sorted->dataNum() != dxs_num) {
         throw new AzException(eyec, "conflict in #data"); 
       }
-      loop(best_split, fx, my_sorted, dxs_num, &total); 
+      loop(best_split, fx, my_sorted, dxs_num, total); 
     }
     else {
-      loop(best_split, fx, sorted, dxs_num, &total); 
+      loop(best_split, fx, sorted, dxs_num, total); 
     }
   }
+}
 
-  if (best_split->fx >= 0) {
-    if (!dmp_out.isNull()) {
-      data->featInfo()->desc(best_split->fx, &best_split->str_desc); 
+/*--------------------------------------------------------*/
+/* Same as loop() except that it goes through the bins of */
+/* a histogram made from the data points of the node.     */
+/*--------------------------------------------------------*/
+void AzFindSplit::loop_hist(AzTrTsplit *best_split, 
+                       int fx, /* feature# */
+                       const AzHistBins *bins, 
+                       const int *dxs, 
+                       int total_size, 
+                       const Az_forFindSplit *total, 
+                       /*---  work area of size maxBinNum()  ---*/
+                       double *wy_hist, 
+                       double *w_hist, 
+                       int *num_hist)
+{
+  int bin_num = bins->binNum(fx); 
+  const AzByte *codes8 = bins->binCodes8(fx); 
+  const unsigned short *codes16 = bins->binCodes16(fx); 
+  const double *tarDw = target->tarDw_arr(); 
+  const double *dw = target->dw_arr(); 
+  const float *tarDw_f = target->tarDw_arr_f(); /* NULL unless single */
+  const float *dw_f = target->dw_arr_f(); 
+
+  /*---  make a histogram  ---*/
+  int bx; 
+  for (bx = 0; bx < bin_num; ++bx) {
+    wy_hist[bx] = w_hist[bx] = 0; 
+    num_hist[bx] = 0; 
+  }
+  if (codes8 != NULL) {
+    if (tarDw_f != NULL) _make_hist(dxs, total_size, codes8, tarDw_f, dw_f, wy_hist, w_hist, num_hist); 
+    else                 _make_hist(dxs, total_size, codes8, tarDw, dw, wy_hist, w_hist, num_hist); 
+  }
+  else {
+    if (tarDw_f != NULL) _make_hist(dxs, total_size, codes16, tarDw_f, dw_f, wy_hist, w_hist, num_hist); 
+    else                 _make_hist(dxs, total_size, codes16, tarDw, dw, wy_hist, w_hist, num_hist); 
+  }
+
+  /*---  first everyone is in GT; move the bins from GT to LE  ---*/
+  int dest_size = 0; 
+  Az_forFindSplit i[2];
+  Az_forFindSplit *src = &i[1], *dest = &i[0]; 
+  double bestP[2] = {0,0}; 
+  for (bx = 0; bx < bin_num; ++bx) {
+    if (num_hist[bx] == 0) continue; 
+    dest_size += num_hist[bx];  
+    if (dest_size >= total_size) {
+      break; /* don't allow all vs nothing */
+    }
+    dest->wy_sum += wy_hist[bx]; 
+    dest->w_sum += w_hist[bx]; 
+
+    if (min_size > 0) {
+      if (dest_size < min_size) {
+        continue; 
+      }
+      if (total_size - dest_size < min_size) {
+        break; 
+      }
+    }
+
+    src->wy_sum = total->wy_sum - dest->wy_sum; 
+    src->w_sum  = total->w_sum  - dest->w_sum; 
+
+    double gain = evalSplit(i, bestP); 
+    if (gain > best_split->gain) {
+      best_split->reset_values(fx, bins->border(fx, bx), gain, 
+                               bestP[0], bestP[1]); 
     }
   }
 }
@@ -123,6 +325,11 @@ void AzFindSplit::loop(AzTrTsplit *best_split,
   AzCursor cursor; 
   sorted->rewind(cursor); 
 
+  const double *tarDw = target->tarDw_arr(); 
+  const double *dw = target->dw_arr(); 
+  const float *tarDw_f = target->tarDw_arr_f(); /* NULL unless single */
+  const float *dw_f = target->dw_arr_f(); 
+
   for ( ; ; ) {
     double value; 
     int index_num; 
@@ -134,15 +341,9 @@ void AzFindSplit::loop(AzTrTsplit *best_split,
       break; /* don't allow all vs nothing */
     }
 
-    const double *tarDw = target->tarDw_arr(); 
-    const double *dw = target->dw_arr(); 
     double wy_sum_move = 0, w_sum_move = 0; 
-    int ix; 
-    for (ix = 0; ix < index_num; ++ix) {
-      int dx = index[ix]; 
-      wy_sum_move += tarDw[dx]; 
-      w_sum_move += dw[dx]; 
-    }
+    if (tarDw_f != NULL) _sum_move(index, index_num, tarDw_f, dw_f, &wy_sum_move, &w_sum_move); 
+    else                 _sum_move(index, index_num, tarDw, dw, &wy_sum_move, &w_sum_move); 
     dest->wy_sum += wy_sum_move; 
     dest->w_sum += w_sum_move; 
 
@@ -24,6 +24,7 @@
 #include "AzTrTtarget.hpp"
 #include "AzTrTsplit.hpp"
 #include "AzTrTree.hpp"
+#include "AzThreads.hpp"
 
 class Az_forFindSplit {
 public:
@@ -47,21 +48,25 @@ protected:
   AzIntArr ia_feats; 
   const AzIntArr *ia_fx; 
 
+  AzThreads *threads; /* may be NULL */
+
 public:
   AzFindSplit() : target(NULL), data(NULL), tree(NULL), ia_fx(NULL), 
-                  min_size(-1) {}
+                  min_size(-1), threads(NULL) {}
   ~AzFindSplit() {}
   void reset() {
     target = NULL;
     data = NULL; 
     tree = NULL;  
     min_size = -1; 
+    threads = NULL; 
   }
 
   void _begin(const AzTrTree_ReadOnly *inp_tree, 
               const AzDataForTrTree *inp_data, 
               const AzTrTtarget *inp_target, 
-              int inp_min_size); 
+              int inp_min_size, 
+              AzThreads *inp_threads=NULL); /* for going through features in parallel */
   void _end() {
     reset(); 
   }
@@ -94,6 +99,24 @@ protected:
             const AzSortedFeat *sorted, 
             int dxs_num, 
             const Az_forFindSplit *total); 
+  void loop_hist(AzTrTsplit *best_split, 
+                 int fx, /* feature# */
+                 const AzHistBins *bins, 
+                 const int *dxs, 
+                 int dxs_num, 
+                 const Az_forFindSplit *total, 
+                 double *wy_hist, double *w_hist, int *num_hist); /* work area */
+
+  /*---  go through features[fx_begin:fx_end-1]  ---*/
+  void _findBestSplit(const AzSortedFeatArr *sorted_arr, /* NULL with histograms */
+                      const int *fxs, /* may be NULL */
+                      int fx_begin, int fx_end, 
+                      const int *dxs, int dxs_num, 
+                      const Az_forFindSplit *total, 
+                      /*---  output  ---*/
+                      AzTrTsplit *best_split); 
+
+  friend class AzFindSplit_Task; 
 }; 
 
 #endif 
@@ -0,0 +1,152 @@
+/* * * * *
+ *  AzHistBins.cpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+
+#include "AzHistBins.hpp"
+
+/*--------------------------------------------------------*/
+static int az_compare_double_A(const void *v1, const void *v2)
+{
+  double d1 = *(const double *)v1; 
+  double d2 = *(const double *)v2; 
+  if (d1 < d2) return -1; 
+  if (d1 > d2) return 1; 
+  return 0; 
+}
+
+/*--------------------------------------------------------*/
+void AzHistBins::reset(const AzSmat *m_tran, 
+                       int max_bin)
+{
+  const char *eyec = "AzHistBins::reset"; 
+  if (max_bin < 2 || max_bin > max_bin_max) {
+    throw new AzException(eyec, "max_bin is out of range"); 
+  }
+  reset(); 
+  data_num = m_tran->rowNum(); 
+  f_num = m_tran->colNum(); 
+
+  a_borders.alloc(&borders, f_num, eyec, "borders"); 
+  AZint8 code_num = (AZint8)f_num*(AZint8)data_num; 
+  if (max_bin <= max_bin_byte) a_codes8.alloc(&codes8, code_num, eyec, "codes8"); 
+  else                         a_codes16.alloc(&codes16, code_num, eyec, "codes16"); 
+
+  AzDvect v_val, v_sorted; 
+  int fx; 
+  for (fx = 0; fx < f_num; ++fx) {
+    v_val.set(m_tran->col(fx)); 
+    const double *val = v_val.point(); 
+
+    v_sorted.set(&v_val); 
+    double *sorted_val = v_sorted.point_u(); 
+    qsort(sorted_val, data_num, sizeof(sorted_val[0]), az_compare_double_A); 
+    set_borders(sorted_val, data_num, max_bin, &borders[fx]); 
+
+    /*---  assign a bin to each data point  ---*/
+    const double *border = borders[fx].point(); 
+    int bin_num = borders[fx].rowNum(); 
+    max_bin_num = MAX(max_bin_num, bin_num); 
+    AZint8 offs = (AZint8)fx*(AZint8)data_num; 
+    int dx; 
+    for (dx = 0; dx < data_num; ++dx) {
+      /*---  the first bin whose border is no smaller than the value  ---*/
+      int lo = 0, hi = bin_num - 1; 
+      while (lo < hi) {
+        int mid = (lo + hi) / 2; 
+        if (border[mid] < val[dx]) lo = mid + 1; 
+        else                       hi = mid; 
+      }
+      if (codes8 != NULL) codes8[offs+dx] = (AzByte)lo; 
+      else                codes16[offs+dx] = (unsigned short)lo; 
+    }
+  }
+}
+
+/*--------------------------------------------------------*/
+/* static */
+void AzHistBins::set_borders(const double *sorted_val, int num, 
+                             int max_bin, 
+                             /*---  output  ---*/
+                             AzDvect *v_border)
+{
+  /*---  distinct values  ---*/
+  int distinct_num = 0; 
+  int ix; 
+  for (ix = 0; ix < num; ++ix) {
+    if (ix == 0 || sorted_val[ix] != sorted_val[ix-1]) ++distinct_num; 
+  }
+  if (distinct_num <= max_bin) {
+    /*---  one bin for each value  ---*/
+    v_border->reform(distinct_num); 
+    double *border = v_border->point_u(); 
+    int bx = 0; 
+    for (ix = 0; ix < num; ++ix) {
+      if (ix == num-1 || sorted_val[ix] != sorted_val[ix+1]) {
+        border[bx++] = sorted_val[ix]; 
+      }
+    }
+    return; 
+  }
+
+  /*---  quantiles; a bin is closed at the end of a run of the same value  ---*/
+  AzDvect v_temp(max_bin); 
+  double *border = v_temp.point_u(); 
+  int bin_num = 0; 
+  int begin = 0; /* first data point in the current bin */
+  for (ix = 0; ix < num; ++ix) {
+    if (ix < num-1 && sorted_val[ix] == sorted_val[ix+1]) continue; 
+    if (bin_num == max_bin-1) continue; /* the last bin takes the rest */
+    double target_size = (double)(num - begin) / (double)(max_bin - bin_num); 
+    if (ix+1 - begin >= target_size) {
+      border[bin_num++] = sorted_val[ix]; 
+      begin = ix + 1; 
+    }
+  }
+  if (begin < num) {
+    border[bin_num++] = sorted_val[num-1]; 
+  }
+  v_border->reform(bin_num); 
+  double *out_border = v_border->point_u(); 
+  int bx; 
+  for (bx = 0; bx < bin_num; ++bx) out_border[bx] = border[bx]; 
+}
+
+/*--------------------------------------------------------*/
+int AzHistBins::leBin(int fx, double border_val) const
+{
+  const double *border = borders[fx].point(); 
+  int lo = 0, hi = borders[fx].rowNum(); /* answer+1 is in [lo,hi] */
+  while (lo < hi) {
+    int mid = (lo + hi) / 2; 
+    if (border[mid] <= border_val) lo = mid + 1; 
+    else                           hi = mid; 
+  }
+  return lo - 1; 
+}
+
+/*--------------------------------------------------------*/
+double AzHistBins::size() const
+{
+  double code_size = (codes8 != NULL) ? sizeof(codes8[0]) : sizeof(unsigned short); 
+  double sz = code_size * (double)data_num * (double)f_num; 
+  int fx; 
+  for (fx = 0; fx < f_num; ++fx) {
+    sz += sizeof(double) * borders[fx].rowNum(); 
+  }
+  return sz; 
+}
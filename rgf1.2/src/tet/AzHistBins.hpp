@@ -0,0 +1,118 @@
+/* * * * *
+ *  AzHistBins.hpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+
+#ifndef _AZ_HIST_BINS_HPP_
+#define _AZ_HIST_BINS_HPP_
+
+#include "AzUtil.hpp"
+#include "AzSmat.hpp"
+#include "AzDmat.hpp"
+
+//! Column store of training data quantized into bins; used for histogram-based node split search.  
+/**
+  *  Bin boundaries are quantiles of the training data; a border is the largest 
+  *  value in its bin so that "value <= border[bx]" iff "bin <= bx" on training data.  
+  *  A bin# takes one byte if max_bin <= 255, and two bytes otherwise.  
+  *  Each feature has one bin per distinct value if it has no more than max_bin 
+  *  distinct values, in which case nothing is lost.  
+ **/
+class AzHistBins {
+protected:
+  int data_num, f_num; 
+  /*---  [fx*data_num+dx]: bin# of data[dx] on feature[fx]; one of the two  ---*/
+  AzByte *codes8;  
+  AzBaseArray<AzByte, AZint8> a_codes8; 
+  unsigned short *codes16; 
+  AzBaseArray<unsigned short, AZint8> a_codes16; 
+
+  AzDvect *borders; /* [fx]: border of each bin in the ascending order */
+  AzObjArray<AzDvect> a_borders; 
+  int max_bin_num; 
+
+public:
+  static const int max_bin_max = 65535; 
+  static const int max_bin_byte = 255;  /* up to this, a bin# takes one byte */ 
+
+  AzHistBins() : data_num(0), f_num(0), codes8(NULL), codes16(NULL), 
+                 borders(NULL), max_bin_num(0) {}
+  void reset() {
+    a_codes8.free(&codes8); 
+    a_codes16.free(&codes16); 
+    a_borders.free(&borders); 
+    data_num = f_num = max_bin_num = 0; 
+  }
+  void reset(const AzSmat *m_tran, /* transpose of data: #data x #feat */
+             int max_bin); 
+
+  inline bool isEmpty() const {
+    return (f_num <= 0); 
+  }
+  inline int dataNum() const { return data_num; }
+  inline int featNum() const { return f_num; }
+  inline int binNum(int fx) const {
+    check_fx(fx, "AzHistBins::binNum"); 
+    return borders[fx].rowNum(); 
+  }
+  inline int maxBinNum() const { /* over all features */
+    return max_bin_num; 
+  }
+  /*---  only one of these is not NULL  ---*/
+  inline const AzByte *binCodes8(int fx) const {
+    check_fx(fx, "AzHistBins::binCodes8"); 
+    if (codes8 == NULL) return NULL; 
+    return codes8 + (AZint8)fx*(AZint8)data_num; 
+  }
+  inline const unsigned short *binCodes16(int fx) const {
+    check_fx(fx, "AzHistBins::binCodes16"); 
+    if (codes16 == NULL) return NULL; 
+    return codes16 + (AZint8)fx*(AZint8)data_num; 
+  }
+  inline int binCode(int dx, int fx) const {
+    AZint8 pos = (AZint8)fx*(AZint8)data_num + dx; 
+    if (codes8 != NULL) return codes8[pos]; 
+    return codes16[pos]; 
+  }
+  inline double border(int fx, int bx) const {
+    check_fx(fx, "AzHistBins::border"); 
+    return borders[fx].get(bx); 
+  }
+
+  /*---  the last bin whose border is no greater than border_val; -1 if none  ---*/
+  /*---  "bin <= leBin(fx,border_val)" means "value <= border_val"            ---*/
+  /*---  exactly if border_val is a border or the bins have one value each    ---*/
+  int leBin(int fx, double border_val) const; 
+  inline bool isLE(int dx, int fx, double border_val) const {
+    check_fx(fx, "AzHistBins::isLE"); 
+    return (binCode(dx, fx) <= leBin(fx, border_val)); 
+  }
+
+  /*---  bytes used  ---*/
+  double size() const; 
+
+protected:
+  inline void check_fx(int fx, const char *eyec) const {
+    if (fx < 0 || fx >= f_num) {
+      throw new AzException(eyec, "feature# is out of range"); 
+    }
+  }
+  static void set_borders(const double *sorted_val, int num, 
+                          int max_bin, 
+                          AzDvect *v_border); /* output */
+}; 
+#endif 
@@ -115,17 +115,25 @@ void AzOptOnTree::copy_from(const AzOptOnTree *inp)
   reg_depth = inp->reg_depth; 
   loss_type = inp->loss_type; 
   max_ite_num = inp->max_ite_num; 
+  full_interval = inp->full_interval; 
+  /*---  a copy (e.g., for saving models) updates all on the first call  ---*/
+  opt_count = 0; 
+  last_f_num = inp->last_f_num; 
+  active_fx0 = 0; 
 
   doRefreshP = inp->doRefreshP; 
   doIntercept = inp->doIntercept; 
   doUnregIntercept = inp->doUnregIntercept; 
   doUseAvg = inp->doUseAvg; 
+  doFastDeriv = inp->doFastDeriv; 
+  doSingle = inp->doSingle; 
 
   ens = NULL; 
   tree_feat = NULL; 
 
   out = inp->out; 
   my_dmp_out = inp->my_dmp_out; 
+  threads.reset(inp->threads.threadNum()); 
 }
 
 /*--------------------------------------------------------*/
@@ -167,11 +175,15 @@ void AzOptOnTree::iterate(int inp_ite_num,
     o.printV_posiOnly("sig=", (sig>=0)?sig:sigma); 
 //    o.printLoss("", loss_type); 
     o.printV("", AzLoss::lossName(loss_type)); 
+    if (active_fx0 > 0) {
+      o.printV("#new_feat=", tree_feat->featNum() - active_fx0); 
+    }
     o.printEnd(); 
   }
   if (ite_num <= 0) {
     return; 
   }
+  sync_single(); 
 
   double nn; 
   if (AzDvect::isNull(&v_fixed_dw)) nn = v_y.rowNum(); 
@@ -205,6 +217,9 @@ void AzOptOnTree::iterate(int inp_ite_num,
       break; 
     }
   }
+  if (doSingle) {
+    refreshPred(); /* v_p from the weights */
+  }
   dumpWeights(my_dmp_out); 
 }
 
@@ -222,8 +237,10 @@ void AzOptOnTree::monitorLoss(int ite,
     fixed_dw = v_fixed_dw.point(); 
     nn = v_fixed_dw.sum(); 
   }
-  int data_num = v_p.rowNum(); 
-  const double *p = v_p.point(); 
+  AzDvect v_temp; 
+  const AzDvect *my_v_p = pred(&v_temp); 
+  int data_num = my_v_p->rowNum(); 
+  const double *p = my_v_p->point(); 
   double uloss_sum=0; 
   int t=0,g=0,ok=0; 
   int dx; 
@@ -264,7 +281,8 @@ double AzOptOnTree::update(double inp_nlam,
   /*---  for numerical stability  ---*/
   double py_avg = 0; 
   if (loss_type == AzLoss_Expo) {
-    py_avg = AzLoss::py_avg(&v_p, &v_y); 
+    AzDvect v_temp; 
+    py_avg = AzLoss::py_avg(pred(&v_temp), &v_y); 
     double nlam_scale = AzLoss::lamScale(py_avg); 
     if (nlam > 0) {
       nlam *= nlam_scale; 
@@ -297,20 +315,109 @@ void AzOptOnTree::_update_with_features(
                       double py_avg, 
                       AzRgf_forDelta *for_del) /* updated */
 {
+  /*---  Leaves of a tree have disjoint data points, so consecutive  ---*/
+  /*---  leaves of the same tree are updated at once, which gives    ---*/
+  /*---  the same result as updating them one by one.                ---*/
+  bool doParallel = (threads.threadNum() > 1); 
+  AzIntArr ia_fx; 
+  int run_tx = -1; 
   int fx; 
   int f_num = tree_feat->featNum(); 
-  for (fx = 0; fx < f_num; ++fx) {
-    if (tree_feat->featInfo(fx)->isRemoved) continue; 
+  for (fx = active_fx0; fx < f_num; ++fx) {
+    const AzTrTreeFeatInfo *fp = tree_feat->featInfo(fx); 
+    if (fp->isRemoved) continue; 
+    if (doParallel && node(fx)->isLeaf()) {
+      if (fp->tx != run_tx) {
+        update_features_parallel(&ia_fx, nlam, nsig, py_avg, for_del); 
+      }
+      ia_fx.put(fx); 
+      run_tx = fp->tx; 
+      continue; 
+    }
+    update_features_parallel(&ia_fx, nlam, nsig, py_avg, for_del); 
+    update_feature(fx, nlam, nsig, py_avg, for_del); 
+  }
+  update_features_parallel(&ia_fx, nlam, nsig, py_avg, for_del); 
+}
 
-    double w = v_w.get(fx); 
-    int dxs_num; 
-    const int *dxs = data_points(fx, &dxs_num); 
-    double my_nlam = reg_depth->apply(nlam, node(fx)->depth); 
-    double my_nsig = reg_depth->apply(nsig, node(fx)->depth); 
-    double delta = getDelta(dxs, dxs_num, w, my_nlam, my_nsig, py_avg, for_del); 
-    v_w.set(fx, w+delta); 
-    updatePred(dxs, dxs_num, delta, &v_p); 
+/*--------------------------------------------------------*/
+void AzOptOnTree::update_feature(int fx, 
+                      double nlam, 
+                      double nsig, 
+                      double py_avg, 
+                      AzRgf_forDelta *for_del) /* updated */
+{
+  double w = v_w.get(fx); 
+  int dxs_num; 
+  const int *dxs = data_points(fx, &dxs_num); 
+  double my_nlam = reg_depth->apply(nlam, node(fx)->depth); 
+  double my_nsig = reg_depth->apply(nsig, node(fx)->depth); 
+  double delta = getDelta(dxs, dxs_num, w, my_nlam, my_nsig, py_avg, for_del); 
+  v_w.set(fx, w+delta); 
+  updatePred(dxs, dxs_num, delta); 
+}
+
+/*------------------------------------------------------------------*/
+/* Each task updates one feature; the features given at once must   */
+/* not share data points.                                           */
+/*------------------------------------------------------------------*/
+class AzOptOnTree_UpdateTask : public virtual AzThreadTask {
+protected:
+  AzOptOnTree *opt; 
+  const int *fxs; 
+  double nlam, nsig, py_avg; 
+  AzRgf_forDelta *for_dels; /* [task#] */
+public:
+  AzOptOnTree_UpdateTask(AzOptOnTree *inp_opt, const int *inp_fxs, 
+                         double inp_nlam, double inp_nsig, double inp_py_avg, 
+                         AzRgf_forDelta *inp_for_dels) {
+    opt = inp_opt; fxs = inp_fxs; 
+    nlam = inp_nlam; nsig = inp_nsig; py_avg = inp_py_avg; 
+    for_dels = inp_for_dels; 
+  }
+  void run(int ix, int thread_no) {
+    opt->update_feature(fxs[ix], nlam, nsig, py_avg, &for_dels[ix]); 
+  }
+}; 
+
+/*--------------------------------------------------------*/
+void AzOptOnTree::update_features_parallel(AzIntArr *ia_fx, /* emptied */
+                      double nlam, 
+                      double nsig, 
+                      double py_avg, 
+                      AzRgf_forDelta *for_del) /* updated */
+{
+  const char *eyec = "AzOptOnTree::update_features_parallel"; 
+  int num; 
+  const int *fxs = ia_fx->point(&num); 
+  if (num <= 0) return; 
+
+  AZint8 data_num = 0; 
+  int ix; 
+  for (ix = 0; ix < num; ++ix) {
+    data_num += node(fxs[ix])->dxs_num; 
   }
+  if (num == 1 || data_num < parallel_data_min) {
+    for (ix = 0; ix < num; ++ix) {
+      update_feature(fxs[ix], nlam, nsig, py_avg, for_del); 
+    }
+  }
+  else {
+    AzBaseArray<AzRgf_forDelta> _for_dels; 
+    AzRgf_forDelta *for_dels = NULL; 
+    _for_dels.alloc(&for_dels, num, eyec, "for_dels"); 
+    AzOptOnTree_UpdateTask task(this, fxs, nlam, nsig, py_avg, for_dels); 
+    threads.run(&task, num); 
+
+    /*---  in the order of serial update so that the sum is the same  ---*/
+    for (ix = 0; ix < num; ++ix) {
+      for_del->changed += for_dels[ix].changed; 
+      for_del->truncated += for_dels[ix].truncated; 
+      for_del->sum_delta += for_dels[ix].sum_delta; 
+      for_del->my_max = MAX(for_del->my_max, for_dels[ix].my_max); 
+    }
+  }
+  ia_fx->reset(); 
 }
 
 /*--------------------------------------------------------*/
@@ -332,6 +439,7 @@ void AzOptOnTree::_update_with_features_TempFile(
       int nx, fx; 
       iia_nx_fx.get(ix, &nx, &fx); 
       if (tree_feat->featInfo(fx)->isRemoved) continue; /* shouldn't happen though */
+      if (fx < active_fx0) continue; 
 
       double w = v_w.get(fx); 
       int dxs_num; 
@@ -340,7 +448,7 @@ void AzOptOnTree::_update_with_features_TempFile(
       double my_nsig = reg_depth->apply(nsig, node(fx)->depth); 
       double delta = getDelta(dxs, dxs_num, w, my_nlam, my_nsig, py_avg, for_del); 
       v_w.set(fx, w+delta); 
-      updatePred(dxs, dxs_num, delta, &v_p); 
+      updatePred(dxs, dxs_num, delta); 
     }
     ens->tree_u(tx)->releaseDataIndexes(); 
   }
@@ -380,7 +488,7 @@ void AzOptOnTree::update_intercept(
                             var_const, my_nlam, my_nsig, 
                             py_avg, for_delta); 
     var_const += delta; 
-    updatePred(ia_all_dx.point(), ia_all_dx.size(), delta, &v_p); 
+    updatePred(ia_all_dx.point(), ia_all_dx.size(), delta); 
   }
 }
 
@@ -401,21 +509,8 @@ const
     throw new AzException(eyec, "no data indexes"); 
   }
 
-  const double *fixed_dw = NULL; 
-  if (!AzDvect::isNull(&v_fixed_dw)) fixed_dw = v_fixed_dw.point(); 
-
-  const double *p = v_p.point(); 
-  const double *y = v_y.point(); 
-
   double nega_dL = 0, ddL= 0; 
-  if (fixed_dw == NULL) {
-    AzLoss::sum_deriv(loss_type, dxs, dxs_num, p, y, py_avg, 
-                      nega_dL, ddL); 
-  }
-  else {
-    AzLoss::sum_deriv_weighted(loss_type, dxs, dxs_num, p, y, fixed_dw, py_avg, 
-                      nega_dL, ddL); 
-  }
+  sum_deriv(dxs, dxs_num, py_avg, nega_dL, ddL); 
 
   double ddL_nlam = ddL + nlam; 
   if (ddL_nlam == 0) ddL_nlam = 1;  /* this shouldn't happen, though */
@@ -432,6 +527,70 @@ const
   return delta; 
 }       
 
+/*--------------------------------------------------------*/
+void AzOptOnTree::sum_deriv(const int *dxs, int dxs_num, double py_avg, 
+                            /*---  output  ---*/
+                            double &nega_dL, double &ddL) const
+{
+  const double *fixed_dw = NULL; 
+  if (!AzDvect::isNull(&v_fixed_dw)) fixed_dw = v_fixed_dw.point(); 
+
+  const double *p = v_p.point(); 
+  const double *y = v_y.point(); 
+
+  if (doSingle) {
+    const float *fixed_dw_f = (fixed_dw == NULL) ? NULL : f_fixed_dw.point(); 
+    AzLoss::sum_deriv(loss_type, dxs, dxs_num, f_p.point(), f_y.point(), fixed_dw_f, py_avg, 
+                      nega_dL, ddL); 
+  }
+  else if (doFastDeriv) {
+    AzLoss::sum_deriv_vect(loss_type, dxs, dxs_num, p, y, fixed_dw, py_avg, 
+                      nega_dL, ddL); 
+  }
+  else if (fixed_dw == NULL) {
+    AzLoss::sum_deriv(loss_type, dxs, dxs_num, p, y, py_avg, 
+                      nega_dL, ddL); 
+  }
+  else {
+    AzLoss::sum_deriv_weighted(loss_type, dxs, dxs_num, p, y, fixed_dw, py_avg, 
+                      nega_dL, ddL); 
+  }
+}
+
+/*--------------------------------------------------------*/
+void AzOptOnTree::sync_single()
+{
+  if (!doSingle) {
+    f_p.reset(); f_y.reset(); f_fixed_dw.reset(); 
+    return; 
+  }
+  f_p.set(&v_p); 
+  f_y.set(&v_y); 
+  if (!AzDvect::isNull(&v_fixed_dw)) f_fixed_dw.set(&v_fixed_dw); 
+  else                               f_fixed_dw.reset(); 
+}
+
+/*--------------------------------------------------------*/
+const AzDvect *AzOptOnTree::pred(AzDvect *v_temp) const
+{
+  if (!doSingle) return &v_p; 
+  v_temp->set(f_p.point(), f_p.rowNum()); 
+  return v_temp; 
+}
+
+/*--------------------------------------------------------*/
+/* static */
+bool AzOptOnTree::readPrecision(AzParam &p, AzBytArr *s_precision)
+{
+  p.vStr(kw_precision, s_precision); 
+  if (s_precision->length() <= 0 || 
+      s_precision->compare(prec_double) == 0) return false; 
+  if (s_precision->compare(prec_single) == 0) return true; 
+  AzBytArr s(kw_precision); s.c(" should be either "); 
+  s.c(prec_double); s.c(" or "); s.c(prec_single); 
+  throw new AzException(AzInputNotValid, "AzOptOnTree::readPrecision", s.c_str()); 
+}
+
 /*--------------------------------------------------------*/
 void AzOptOnTree::checkParam() const
 {
@@ -447,6 +606,9 @@ void AzOptOnTree::checkParam() const
   if (eta <= 0) {
     throw new AzException(AzInputNotValid, eyec, kw_eta, "must be positive"); 
   }
+  if (full_interval < 0) {
+    throw new AzException(AzInputNotValid, eyec, kw_full_interval, "must be non-negative"); 
+  }
 }
 
 /*--------------------------------------------------------*/
@@ -483,7 +645,18 @@ AzOptOnTree::optimize(AzRgfTreeEnsemble *rgf_ens,
   if (doRefreshP) {
     refreshPred(); 
   }
+
+  /*---  only the features added since the previous call, or all  ---*/
+  int f_num = tree_feat->featNum(); 
+  active_fx0 = 0; 
+  if (full_interval > 1 && opt_count % full_interval != 0) {
+    active_fx0 = MIN(last_f_num, f_num); 
+  }
+  ++opt_count; 
+  last_f_num = f_num; 
+
   iterate(ite_num, lam, sig); 
+  active_fx0 = 0; 
   updateTreeWeights(rgf_ens); 
   ens = NULL; 
   tree_feat = NULL; 
@@ -632,6 +805,8 @@ void AzOptOnTree::printHelp(AzHelp &h) const
   h.item(kw_max_ite_num, help_max_ite_num, s_dflt.c_str()); 
   h.item_experimental(kw_doIntercept, help_doIntercept); 
   h.item(kw_eta, help_eta, eta_dflt); 
+  h.item(kw_full_interval, help_full_interval, 0); 
+  h.item_experimental(kw_doFastDeriv, help_doFastDeriv); 
   h.item_experimental(kw_exit_delta, help_exit_delta, exit_delta_dflt); 
   h.end(); 
 }
@@ -643,12 +818,21 @@ void AzOptOnTree::resetParam(AzParam &p)
   p.vFloat(kw_sigma, &sigma); 
   p.vInt(kw_max_ite_num, &max_ite_num); 
   p.vFloat(kw_eta, &eta); 
+  p.vInt(kw_full_interval, &full_interval); 
   p.vFloat(kw_exit_delta, &exit_delta); 
   p.vFloat(kw_max_delta, &max_delta); 
   p.swOn(&doUseAvg, kw_doUseAvg); 
+  p.swOn(&doFastDeriv, kw_doFastDeriv); 
   p.swOff(&doIntercept, kw_not_doIntercept); /* useless but keep this for compatibility */
   p.swOn(&doIntercept, kw_doIntercept); 
 
+  int num_threads = threads.threadNum(); 
+  p.vInt(kw_num_threads, &num_threads); /* shared with node search */
+  threads.reset(num_threads); 
+
+  AzBytArr s_precision; 
+  doSingle = readPrecision(p, &s_precision); /* shared with node search */
+
   if (max_ite_num <= 0) {
     max_ite_num = max_ite_num_dflt_oth; 
     if (AzLoss::isExpoFamily(loss_type)) {
@@ -672,10 +856,13 @@ void AzOptOnTree::printParam(const AzOut &out,
   o.printV(kw_lambda, lambda); 
   o.printV_posiOnly(kw_sigma, sigma); 
   o.printV(kw_eta, eta); 
+  o.printV_posiOnly(kw_full_interval, full_interval); 
   o.printV(kw_exit_delta, exit_delta); 
   o.printV(kw_max_delta, max_delta); 
 
   o.printSw(kw_doUseAvg, doUseAvg); 
+  o.printSw(kw_doFastDeriv, doFastDeriv); 
+  if (doSingle) o.printV(kw_precision, prec_single); 
   o.printSw(kw_doIntercept, doIntercept); 
 
   o.printSw(kw_opt_beVerbose, beVerbose); 
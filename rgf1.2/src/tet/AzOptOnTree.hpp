@@ -30,6 +30,7 @@
 #include "AzOptimizerT.hpp"
 #include "AzRegDepth.hpp"
 #include "AzParam.hpp"
+#include "AzThreads.hpp"
 
 class AzRgf_forDelta {
 public:
@@ -61,7 +62,10 @@ protected:
   double eta, lambda, sigma, exit_delta, max_delta; 
   AzLossType loss_type; 
   int max_ite_num; 
+  int full_interval; /* >1: only new features except every full_interval times */
   bool doRefreshP, doIntercept, doUnregIntercept, doUseAvg; 
+  bool doFastDeriv; /* AzLoss::sum_deriv_vect */
+  bool doSingle;    /* precision=single */
   AzOut out, my_dmp_out; 
 
   /*---  just pointing  ---*/
@@ -70,6 +74,18 @@ protected:
   const AzTrTreeFeat *tree_feat; 
 
   AzIntArr ia_empty; 
+  AzThreads threads; /* for updating the leaves of a tree at once */
+
+  /*---  for optimizing new features only  ---*/
+  int opt_count;  /* #call of optimize */
+  int last_f_num; /* #feature at the previous call */
+  int active_fx0; /* features before this are not updated */
+
+  /*---  if doSingle, iterate() reads float copies of v_y and v_fixed_dw  ---*/
+  /*---  and updates f_p instead of v_p; v_p is recomputed at the end     ---*/
+  AzFvect f_p, f_y, f_fixed_dw; 
+
+  static const int parallel_data_min = 10000; /* fewer data points: serial */
 
   /*---  default values  ---*/
   static const int max_ite_num_dflt_oth = 10; 
@@ -84,10 +100,11 @@ public:
     var_const(0), fixed_const(0), 
     eta(eta_dflt), lambda(-1), sigma(sigma_dflt), 
     exit_delta(exit_delta_dflt), max_delta(max_delta_dflt), 
-    loss_type(loss_type_dflt), max_ite_num(-1),
+    loss_type(loss_type_dflt), max_ite_num(-1), full_interval(0), 
     doIntercept(false), /* changed on 12/09/2011 */
-    doRefreshP(false), doUnregIntercept(false), doUseAvg(false),  
-    ens(NULL), tree_feat(NULL)
+    doRefreshP(false), doUnregIntercept(false), doUseAvg(false), doFastDeriv(false), doSingle(false), 
+    ens(NULL), tree_feat(NULL), 
+    opt_count(0), last_f_num(0), active_fx0(0)
     {}
 
   ~AzOptOnTree() {}
@@ -147,6 +164,9 @@ public:
     copy_from(inp); 
   }
 
+  /*---  precision=; shared with node search; returns true if single  ---*/
+  static bool readPrecision(AzParam &p, AzBytArr *s_precision); 
+
   void resetPred(const AzBmat *m_tran, 
                  AzDvect *v_p) /* output */
                  const; 
@@ -171,6 +191,7 @@ protected:
     v_y.reset(); 
     v_fixed_dw.reset(); 
     var_const = fixed_const = 0; 
+    opt_count = last_f_num = active_fx0 = 0; 
   }
   void synchronize(); 
 
@@ -185,6 +206,12 @@ protected:
                             AzRgf_forDelta *for_delta);
   virtual void _update_with_features_TempFile(double nlam, double nsig, double py_avg, 
                             AzRgf_forDelta *for_delta);
+  void update_feature(int fx, double nlam, double nsig, double py_avg, 
+                      AzRgf_forDelta *for_delta); 
+  void update_features_parallel(AzIntArr *ia_fx, /* emptied */
+                      double nlam, double nsig, double py_avg, 
+                      AzRgf_forDelta *for_delta); 
+  friend class AzOptOnTree_UpdateTask; 
   void update_intercept(double nlam, double nsig, double py_avg, 
                         AzRgf_forDelta *for_delta); /* updated */
 
@@ -224,6 +251,24 @@ protected:
                                 AzDvect *out_v_p) {
     out_v_p->add(delta, dxs, dxs_num);   
   }
+  /*---  v_p, or f_p in iterate() if doSingle  ---*/
+  inline void updatePred(const int *dxs, int dxs_num, double delta) {
+    if (!doSingle) {
+      updatePred(dxs, dxs_num, delta, &v_p); 
+      return; 
+    }
+    float *fp = f_p.point_u(); 
+    int ix; 
+    for (ix = 0; ix < dxs_num; ++ix) {
+      int dx = dxs[ix]; 
+      fp[dx] = (float)(fp[dx] + delta); 
+    }
+  }
+  void sync_single(); 
+  const AzDvect *pred(AzDvect *v_temp) const; /* v_p, or f_p copied to v_temp */
+  void sum_deriv(const int *dxs, int dxs_num, double py_avg, 
+                 /*---  output  ---*/
+                 double &nega_dL, double &ddL) const; 
   virtual void resetParam(AzParam &param); 
 
   void updateTreeWeights(AzRgfTreeEnsemble *ens) const; 
@@ -91,7 +91,7 @@ void AzOptOnTree_TreeReg::update_weight(int nx,
 
   int dxs_num; 
   const int *dxs = data_points(fx, &dxs_num); 
-  updatePred(dxs, dxs_num, delta, &v_p); 
+  updatePred(dxs, dxs_num, delta); 
 
   /*---  update the weight in the ensemble  ---*/ 
   const AzTrTreeFeatInfo *fp = tree_feat->featInfo(fx); 
@@ -119,19 +119,8 @@ const
     throw new AzException(eyec, "no data indexes"); 
   }
 
-  const double *fixed_dw = NULL; 
-  if (!AzDvect::isNull(&v_fixed_dw)) fixed_dw = v_fixed_dw.point(); 
-  const double *p = v_p.point(); 
-  const double *y = v_y.point(); 
   double nega_dL = 0, ddL= 0; 
-  if (fixed_dw == NULL) {
-    AzLoss::sum_deriv(loss_type, dxs, dxs_num, p, y, py_avg, 
-                      nega_dL, ddL); 
-  }
-  else {
-    AzLoss::sum_deriv_weighted(loss_type, dxs, dxs_num, p, y, fixed_dw, py_avg, 
-                      nega_dL, ddL);
-  }
+  sum_deriv(dxs, dxs_num, py_avg, nega_dL, ddL); 
 
   double dR, ddR; 
   reg->penalty_deriv(nx, &dR, &ddR); 
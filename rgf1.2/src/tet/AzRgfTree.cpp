@@ -33,26 +33,15 @@ void AzRgfTree::findSplit(AzRgf_FindSplit *fs,
   }
 
   AzTrTree::_checkNodes(eyec); 
-  int leaf_num = leafNum(); 
-  if (max_leaf_num > 0) {
-    if (leaf_num >= max_leaf_num) {
-      return;   
-    }
+  if (isFull()) {
+    return;   
   }
 
   _findSplit_begin(fs, inp); 
 
   int nx; 
   for (nx = 0; nx < nodes_used; ++nx) {
-    if (!nodes[nx].isLeaf()) continue; 
-
-    /*---  ---*/
-    if (max_depth > 0 && nodes[nx].depth >= max_depth) {
-      continue; 
-    }
-    if (min_size > 0 && nodes[nx].dxs_num < min_size*2) {
-      continue; 
-    }
+    if (!canSplit(nx)) continue; 
 
     _findSplit(fs, nx, doRefreshAll); 
 
@@ -64,13 +53,74 @@ void AzRgfTree::findSplit(AzRgf_FindSplit *fs,
   _findSplit_end(fs); 
 }
 
+/*--------------------------------------------------------*/
+/* Make everything the leaf search would create or update, so that  */
+/* findSplit_leaf only reads the tree (and writes to split[nx]).    */
+/*--------------------------------------------------------*/
+void AzRgfTree::findSplit_prep(const AzDataForTrTree *data, 
+                               bool doRefreshAll, 
+                               /*---  output  ---*/
+                               AzIntArr *ia_nx) const 
+{
+  ia_nx->reset(); 
+  if (nodes_used <= 0) {
+    return; 
+  }
+  AzTrTree::_checkNodes("AzRgfTree::findSplit_prep"); 
+  if (isFull()) {
+    return; 
+  }
+
+  int nx; 
+  for (nx = 0; nx < nodes_used; ++nx) {
+    if (!canSplit(nx)) continue; 
+    if (!_shouldSearch(nx, doRefreshAll)) continue; 
+
+    if (split[nx] == NULL) split[nx] = new_split(); 
+    else                   split[nx]->reset(); 
+    sorted_array(nx, data); /* in the node order as in findSplit */
+    ia_nx->put(nx); 
+  }
+}
+
+/*--------------------------------------------------------*/
+void AzRgfTree::findSplit_leaf(AzRgf_FindSplit *fs, 
+                               const AzRgf_FindSplit_input &inp, 
+                               int nx) const 
+{
+  _findSplit_begin(fs, inp); 
+  fs->findSplit(nx, split[nx]); 
+  _findSplit_end(fs); 
+}
+
+/*--------------------------------------------------------*/
+void AzRgfTree::findSplit_best(const AzRgf_FindSplit_input &inp, 
+                               /*---  output  ---*/
+                               AzTrTsplit *best_split) const 
+{
+  if (nodes_used <= 0) {
+    return; 
+  }
+  if (isFull()) {
+    return; 
+  }
+  int nx; 
+  for (nx = 0; nx < nodes_used; ++nx) {
+    if (!canSplit(nx)) continue; 
+    if (split[nx]->fx >= 0 && 
+        split[nx]->gain > best_split->gain) {
+      best_split->reset(split[nx], inp.tx, nx); 
+    }
+  }
+}
+
 /*--------------------------------------------------------*/
 void AzRgfTree::removeSplitAssessment() 
 {
   if (split != NULL) {
     int nx; 
     for (nx = 0; nx < nodes_used; ++nx) {
-      delete split[nx]; split[nx] = NULL; 
+      if (split[nx] != NULL) release_split(nx); 
     }
   }
 }
@@ -108,6 +108,19 @@ public:
                  /*---  output  ---*/
                  AzTrTsplit *best_split) const; 
 
+  /*---  to search the leaves of many trees in parallel:             ---*/
+  /*---  prep (serial), leaf (in any order/thread), best (serial)     ---*/
+  virtual void findSplit_prep(const AzDataForTrTree *data, 
+                              bool doRefreshAll, 
+                              /*---  output  ---*/
+                              AzIntArr *ia_nx) const; /* leaves to be searched */
+  virtual void findSplit_leaf(AzRgf_FindSplit *fs, 
+                              const AzRgf_FindSplit_input &inp, 
+                              int nx) const; 
+  virtual void findSplit_best(const AzRgf_FindSplit_input &inp, 
+                              /*---  output  ---*/
+                              AzTrTsplit *best_split) const; 
+
   inline virtual int makeRoot(const AzDataForTrTree *dfd, 
                       const AzIntArr *ia_tr_dx=NULL) {
     AzTrTree::_genRoot(max_leaf_num, dfd, ia_tr_dx); 
@@ -170,10 +183,8 @@ protected:
 
   virtual inline void _findSplit(AzRgf_FindSplit *fs, 
                                  int nx, bool doRefreshAll) const {
-    if (doRefreshAll || 
-        split[nx] == NULL || 
-        nx == root_nx) {
-      if (split[nx] == NULL) split[nx] = new AzTrTsplit(); 
+    if (_shouldSearch(nx, doRefreshAll)) {
+      if (split[nx] == NULL) split[nx] = new_split(); 
       else                   split[nx]->reset();
       fs->findSplit(nx, split[nx]); 
     }
@@ -181,6 +192,20 @@ protected:
   virtual inline void _findSplit_end(AzRgf_FindSplit *fs) const {
     fs->end(); 
   }
+  virtual inline bool _shouldSearch(int nx, bool doRefreshAll) const {
+    return (doRefreshAll || split[nx] == NULL || nx == root_nx); 
+  }
+
+  bool isFull() const {
+    if (max_leaf_num > 0 && leafNum() >= max_leaf_num) return true; 
+    return false; 
+  }
+  bool canSplit(int nx) const {
+    if (!nodes[nx].isLeaf()) return false; 
+    if (max_depth > 0 && nodes[nx].depth >= max_depth) return false; 
+    if (min_size > 0 && nodes[nx].dxs_num < min_size*2) return false; 
+    return true; 
+  }
 
   virtual void adjustParam(); 
 }; 
@@ -27,6 +27,7 @@
 #include "AzParam.hpp"
 #include "AzFsinfo.hpp"
 #include "AzHelp.hpp"
+#include "AzThreads.hpp"
 
 class AzRgf_FindSplit_input {
 public:
@@ -35,17 +36,20 @@ public:
   const AzTrTtarget *target; 
   double lam_scale; /*!< for numerical stability of exp loss */
   double nn; /* sum of data point weights if weighted */
+  AzThreads *threads; /* may be NULL */
 
   AzRgf_FindSplit_input(int inp_tx, 
                         const AzDataForTrTree *inp_data, 
                         const AzTrTtarget *inp_target, 
                         double inp_lam_scale, 
-                        double inp_nn) {
+                        double inp_nn, 
+                        AzThreads *inp_threads=NULL) {
     tx = inp_tx; 
     data = inp_data; 
     target = inp_target; 
     lam_scale = inp_lam_scale; 
     nn = (double)inp_nn; 
+    threads = inp_threads; 
   }
 }; 
 
@@ -56,6 +60,8 @@ public:
  **/
 class AzRgf_FindSplit {
 public:
+  virtual ~AzRgf_FindSplit() {}
+
   virtual void reset(AzParam &param, 
                      const AzRegDepth *reg_depth,
                      const AzOut &out) = 0; 
@@ -82,6 +88,12 @@ public:
 
   virtual void printParam(const AzOut &out) const = 0;  
   virtual void printHelp(AzHelp &h) const = 0; 
+
+  /*---  a copy that can search nodes in parallel with the original;   ---*/
+  /*---  NULL if the search depends on state shared within a tree     ---*/
+  virtual AzRgf_FindSplit *clone() const {
+    return NULL; 
+  }
 }; 
 #endif 
 
@@ -26,7 +26,7 @@ void AzRgf_FindSplit_Dflt::begin(
                    const AzRgf_FindSplit_input &inp, /* tx is not used */
                    int inp_min_size)
 {
-  AzFindSplit::_begin(inp_tree, inp.data, inp.target, inp_min_size); 
+  AzFindSplit::_begin(inp_tree, inp.data, inp.target, inp_min_size, inp.threads); 
 
   nlam = inp.nn*lambda; 
   nsig = inp.nn*sigma; 
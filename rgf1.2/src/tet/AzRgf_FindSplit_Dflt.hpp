@@ -79,6 +79,16 @@ public:
     AzFindSplit::_pickFeats(pick_num, f_num); 
   }
 
+  /*---  shares the picked features with this; valid until next pickFeats  ---*/
+  virtual AzRgf_FindSplit *clone() const {
+    AzRgf_FindSplit_Dflt *fs = new AzRgf_FindSplit_Dflt(); 
+    fs->lambda = lambda; 
+    fs->sigma = sigma; 
+    fs->reg_depth = reg_depth; 
+    fs->ia_fx = ia_fx; 
+    return fs; 
+  }
+
   virtual void printParam(const AzOut &out) const; 
   virtual void printHelp(AzHelp &h) const; 
 
@@ -57,6 +57,11 @@ public:
   //! override 
   virtual void findSplit(int nx, AzTrTsplit *best_split); 
 
+  //! override: reg is shared by the leaves of a tree, so no parallel search 
+  virtual AzRgf_FindSplit *clone() const {
+    return NULL; 
+  }
+
   //! override AzFindSplit::evalSplit
   virtual double evalSplit(const Az_forFindSplit i[2], 
                            double bestP[2]) const; 
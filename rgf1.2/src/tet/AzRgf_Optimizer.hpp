@@ -78,6 +78,20 @@ public:
              int *nz_f_num)
              const = 0;
 
+  /*! Test, updating the prediction made by the previous call by the changes since then. */
+  /*! The default is to test from scratch. */
+  virtual void apply_incr(const AzDataForTrTree *data, 
+             AzBmat *b_test_tran, /*!< inout */
+             AzDvect *v_test_w,   /*!< inout: weights that v_test_p reflects */
+             double *test_const,  /*!< inout: constant that v_test_p reflects */
+             const AzTrTreeEnsemble_ReadOnly *ens, 
+             AzDvect *v_test_p,   /*!< inout: prediction on test data */
+             int *f_num, int *nz_f_num) const {
+    apply(data, b_test_tran, ens, v_test_p, f_num, nz_f_num); 
+    v_test_w->reform(0); /* not kept */
+    *test_const = 0; 
+  }
+
   /*! simulate end of the training and return the test results */
   virtual void temp_update_apply(const AzDataForTrTree *tr_data, 
                           AzRgfTreeEnsemble *temp_ens, 
@@ -119,6 +119,71 @@ void AzRgf_Optimizer_Dflt::apply(const AzDataForTrTree *test_data,
   _info(ens, trainer, &feat1, f_num, nz_f_num); 
 } 
 
+/*------------------------------------------------------------------*/
+/* Only the new features are generated (as in apply), and only the  */
+/* weights that changed since the previous call are applied, so the */
+/* cost is proportional to what changed.                            */
+/*------------------------------------------------------------------*/
+void AzRgf_Optimizer_Dflt::apply_incr(const AzDataForTrTree *test_data, 
+                                 AzBmat *b_test_tran,  /* inout */
+                                 AzDvect *v_test_w,    /* inout */
+                                 double *test_const,   /* inout */
+                                 const AzTrTreeEnsemble_ReadOnly *ens, 
+                                 /*--- output ---*/
+                                 AzDvect *v_p,         /* inout */
+                                 int *f_num, 
+                                 int *nz_f_num) const 
+{
+  if (test_data == NULL) {
+    _info(ens, trainer, &feat1, f_num, nz_f_num); 
+    return; 
+  }
+
+  const AzDvect *v_w = trainer->weights(); 
+  int old_f_num = b_test_tran->colNum(); 
+  if (v_p->rowNum() != test_data->dataNum() || 
+      v_test_w->rowNum() != old_f_num || old_f_num == 0) {
+    /*---  nothing to start from  ---*/
+    apply(test_data, b_test_tran, ens, v_p, f_num, nz_f_num); 
+    v_test_w->set(v_w); 
+    *test_const = trainer->constant(); 
+    return; 
+  }
+
+  /*---  take out the removed features before their columns are cleared  ---*/
+  double *test_w = v_test_w->point_u(); 
+  int fx; 
+  for (fx = 0; fx < old_f_num; ++fx) {
+    if (test_w[fx] != 0 && feat1.featInfo(fx)->isRemoved) {
+      const AzIntArr *ia_dx = b_test_tran->on_rows(fx); 
+      v_p->add(-test_w[fx], ia_dx->point(), ia_dx->size()); 
+      test_w[fx] = 0; 
+    }
+  }
+
+  feat1.updateMatrix(test_data, ens, b_test_tran); 
+
+  /*---  changes of the weights and the constant  ---*/
+  double const_delta = trainer->constant() - *test_const; 
+  if (const_delta != 0) {
+    v_p->add(const_delta); 
+  }
+  const double *w = v_w->point(); 
+  int w_num = v_w->rowNum(); 
+  for (fx = 0; fx < w_num; ++fx) {
+    double prev_w = (fx < old_f_num) ? test_w[fx] : 0; 
+    if (w[fx] != prev_w) {
+      const AzIntArr *ia_dx = b_test_tran->on_rows(fx); 
+      v_p->add(w[fx] - prev_w, ia_dx->point(), ia_dx->size()); 
+    }
+  }
+  v_test_w->set(v_w); 
+  *test_const = trainer->constant(); 
+
+  /*---  set info  ---*/
+  _info(ens, trainer, &feat1, f_num, nz_f_num); 
+} 
+
 /*------------------------------------------------------------------*/
 /*------------------------------------------------------------------*/
 bool AzRgf_Optimizer_Dflt::resetParam(AzParam &p)
@@ -106,6 +106,13 @@ public:
              /*---  output  ---*/
              AzDvect *v_p, 
              int *f_num, int *nz_f_num) const; 
+  virtual void apply_incr(const AzDataForTrTree *data, 
+             AzBmat *b_test_tran, /* inout */
+             AzDvect *v_test_w,   /* inout */
+             double *test_const,  /* inout */
+             const AzTrTreeEnsemble_ReadOnly *ens, 
+             AzDvect *v_test_p,   /* inout */
+             int *f_num, int *nz_f_num) const; 
 
   virtual void printHelp(AzHelp &h) const; 
 
@@ -40,6 +40,10 @@
 #define kw_f_ratio "f_ratio="
 #define kw_random_seed "random_seed="
 #define kw_doPassiveRoot "PassiveRoot"
+#define kw_num_threads "num_threads="
+#define kw_precision "precision="
+#define prec_double "double"
+#define prec_single "single"
 
 #define help_loss           "Loss function"
 #define help_max_tree_num   "Stop training when the number of trees exceeds this number."
@@ -57,6 +61,8 @@
 #define help_f_ratio "For feature sampling."
 #define help_random_seed "Random seed."
 #define help_doPassiveRoot "Consider to split the root (to start a new tree) only if there is no other choice."
+#define help_num_threads "Number of threads for node search, weight optimization, and data setup (transposing training and test data).  0: as many as the cores."
+#define help_precision "double|single.  With single, training targets, data point weights, and predictions are read in single precision in node search and weight optimization (sums are in double), for less memory traffic.  Results may differ slightly from double."
 
 /*--- AzRgforest_Sim ---*/
 #define kw_s "shrink="
@@ -91,6 +97,8 @@
 #define kw_opt_beVerbose "Verbose_opt"
 #define kw_not_doIntercept "DontUseIntercept"
 #define kw_doIntercept     "UseIntercept"
+#define kw_full_interval "opt_full_interval="
+#define kw_doFastDeriv "FastLossDeriv"
 
 #define help_lambda "lambda.  Regularization coefficient."        
 #define help_sigma  "L1 regularization coefficient." 
@@ -105,6 +113,8 @@
 #define help_opt_beVerbose "Print information on weight optimization."
 #define help_not_doIntercept "Do not include intercept in the weight optimization."
 #define help_doIntercept     "Include intercept in the weight optimization."
+#define help_full_interval "If greater than 1, weight optimization updates only the weights of the leaves added since the previous optimization, except that every this many times it updates all the weights.  0: update all the weights every time."
+#define help_doFastDeriv "Sum loss derivatives with AVX2 if the CPU has it (square, exponential, and log loss).  Results may differ from the default in the last bits.  Not used with precision=single."
 
 /*--- AzRgf_FindSplit_Dflt ---*/
 /* #define kw_lambda "reg_L2="  shared with opt */
@@ -28,6 +28,7 @@ void AzRgforest::cold_start(const char *param,
                         const AzDvect *v_fixed_dw, 
                         const AzOut &out_req)
 {
+  const char *eyec = "AzRgforest::cold_start"; 
   out = out_req; 
   s_config.reset(param); 
 
@@ -41,7 +42,7 @@ void AzRgforest::cold_start(const char *param,
   initTarget(v_y, v_fixed_dw);    
   initEnsemble(az_param, max_tree_num); /* initialize tree ensemble */
   fs->reset(az_param, reg_depth, out); /* initialize node search */
-  az_param.check(out); 
+  checkParam(az_param, eyec); 
   l_num = 0; /* initialize leaf node counter */
 
   if (!beVerbose) { 
@@ -91,7 +92,7 @@ void AzRgforest::warm_start(const char *param,
   initTarget(v_y, v_fixed_dw); 
 
   fs->reset(az_param, reg_depth, out); /* initialize node search */
-  az_param.check(out); 
+  checkParam(az_param, eyec); 
   l_num = ens->leafNum();  /* warm-up #leaf */
 
   if (!beVerbose) { 
@@ -149,6 +150,7 @@ void AzRgforest::initTarget(const AzDvect *v_y,
                             const AzDvect *v_fixed_dw)
 {
   target.reset(v_y, v_fixed_dw);
+  target.setSingle(doSingle); 
   resetTarget(); 
 }
 
@@ -157,7 +159,7 @@ void AzRgforest::setInput(AzParam &p,
                           const AzSmat *m_x, 
                           const AzSvFeatInfo *featInfo)
 {
-  dflt_data.reset_data(out, m_x, p, beTight, featInfo); 
+  dflt_data.reset_data(out, m_x, p, beTight, featInfo, &threads); 
   data = &dflt_data; 
 
   f_pick = -1; 
@@ -367,7 +369,11 @@ void AzRgforest::searchBestSplit(AzTrTsplit *best_split) /* must be initialize b
     fs->pickFeats(f_pick, data->featNum()); 
   }
 
-  AzRgf_FindSplit_input input(-1, data, tar, lam_scale, nn); 
+  AzRgf_FindSplit_input input(-1, data, tar, lam_scale, nn, &threads); 
+  if (searchBestSplit_parallel(input, my_first, last_tx, doRefreshAll, best_split)) {
+    return; 
+  }
+
   int tx; 
   for (tx = my_first; tx <= last_tx; ++tx) {
     input.tx = tx; 
@@ -381,6 +387,124 @@ void AzRgforest::searchBestSplit(AzTrTsplit *best_split) /* must be initialize b
   }
 }
 
+/*------------------------------------------------------------------*/
+/* Each task searches one leaf (tree, node) with its thread's copy  */
+/* of the node search.                                              */
+/*------------------------------------------------------------------*/
+class AzRgforest_SearchTask : public virtual AzThreadTask {
+protected:
+  const AzRgfTreeEnsemble *ens; 
+  const AzRgfTree *rootonly_tree; 
+  int rootonly_tx; 
+  const AzIIFarr *leaves; /* (tx, nx, #data) */
+  AzRgf_FindSplit **thread_fs; 
+  const AzRgf_FindSplit_input *input; 
+public:
+  AzRgforest_SearchTask(const AzRgfTreeEnsemble *inp_ens, 
+                        const AzRgfTree *inp_rootonly_tree, 
+                        int inp_rootonly_tx, 
+                        const AzIIFarr *inp_leaves, 
+                        AzRgf_FindSplit **inp_thread_fs, 
+                        const AzRgf_FindSplit_input *inp_input) {
+    ens = inp_ens; rootonly_tree = inp_rootonly_tree; rootonly_tx = inp_rootonly_tx; 
+    leaves = inp_leaves; thread_fs = inp_thread_fs; input = inp_input; 
+  }
+  void run(int lx, int thread_no) {
+    int tx, nx; 
+    leaves->get(lx, &tx, &nx); 
+    const AzRgfTree *tree = rootonly_tree; 
+    if (tx != rootonly_tx) tree = ens->tree_u(tx); 
+    AzRgf_FindSplit_input my_input(tx, input->data, input->target, 
+                                   input->lam_scale, input->nn); /* no nested threads */
+    tree->findSplit_leaf(thread_fs[thread_no], my_input, nx); 
+  }
+}; 
+
+/*------------------------------------------------------------------*/
+/* Search the leaves of all the trees in parallel.                  */
+/* Returns false (having done nothing) if it's not worth it or not  */
+/* possible; then the caller should do the serial search.           */
+/*------------------------------------------------------------------*/
+bool AzRgforest::searchBestSplit_parallel(const AzRgf_FindSplit_input &input, 
+                             int my_first, int last_tx, 
+                             bool doRefreshAll, 
+                             /*---  output  ---*/
+                             AzTrTsplit *best_split)
+{
+  const char *eyec = "AzRgforest::searchBestSplit_parallel"; 
+  int thread_num = threads.threadNum(); 
+  if (thread_num <= 1) return false; 
+
+  /*---  one copy of the node search for each thread  ---*/
+  AzRgf_FindSplit **thread_fs = NULL; 
+  AzObjPtrArray<AzRgf_FindSplit> a_thread_fs; 
+  a_thread_fs.alloc(&thread_fs, thread_num, eyec, "thread_fs"); 
+  int thread_no; 
+  for (thread_no = 0; thread_no < thread_num; ++thread_no) {
+    thread_fs[thread_no] = fs->clone(); 
+    if (thread_fs[thread_no] == NULL) return false; 
+  }
+
+  /*---  leaves to be searched  ---*/
+  bool doRootonly = !doPassiveRoot; 
+  AzIIFarr leaves; 
+  AzIntArr ia_nx; 
+  int tx; 
+  for (tx = my_first; tx <= last_tx+1; ++tx) {
+    const AzRgfTree *tree = NULL; 
+    int my_tx = tx; 
+    if (tx <= last_tx) tree = ens->tree_u(tx); 
+    else if (doRootonly) {
+      tree = rootonly_tree; 
+      my_tx = rootonly_tx; 
+    }
+    else break; 
+
+    tree->findSplit_prep(data, doRefreshAll, &ia_nx); 
+    int ix; 
+    for (ix = 0; ix < ia_nx.size(); ++ix) {
+      int nx = ia_nx.get(ix); 
+      leaves.put(my_tx, nx, tree->node(nx)->dxs_num); 
+    }
+  }
+
+  if (leaves.size() < thread_num) {
+    /*---  too few; leave it to the per-feature parallelism  ---*/
+    int lx; 
+    for (lx = 0; lx < leaves.size(); ++lx) {
+      int nx; 
+      leaves.get(lx, &tx, &nx); 
+      const AzRgfTree *tree = (tx == rootonly_tx) ? rootonly_tree : ens->tree_u(tx); 
+      AzRgf_FindSplit_input my_input(input); 
+      my_input.tx = tx; 
+      tree->findSplit_leaf(fs, my_input, nx); 
+    }
+  }
+  else {
+    /*---  largest first so that the threads finish at about the same time  ---*/
+    leaves.sort_FloatInt1Int2(false); 
+    AzRgforest_SearchTask task(ens, rootonly_tree, rootonly_tx, 
+                               &leaves, thread_fs, &input); 
+    threads.run(&task, leaves.size()); 
+  }
+
+  /*---  in the order of serial search so that the result is the same  ---*/
+  AzRgf_FindSplit_input my_input(input); 
+  for (tx = my_first; tx <= last_tx; ++tx) {
+    my_input.tx = tx; 
+    ens->tree_u(tx)->findSplit_best(my_input, best_split); 
+  }
+  if (doRootonly) {
+    my_input.tx = rootonly_tx; 
+    rootonly_tree->findSplit_best(my_input, best_split); 
+  }
+  else if (best_split->tx < 0 || best_split->fx < 0) {
+    my_input.tx = rootonly_tx; 
+    rootonly_tree->findSplit(fs, my_input, doRefreshAll, best_split); 
+  }
+  return true; 
+}
+
 /*------------------------------------------------------------------*/
 /* print this to stdout only when Dump is specified */
 void AzRgforest::show_tree_info() const
@@ -451,6 +575,8 @@ void AzRgforest::_updateTarget_OtherLoss(const AzRgfTree *tree,
 
   double *tar_dw = target.tarDw_forUpdate()->point_u(); 
   double *dw = target.dw_forUpdate()->point_u(); 
+  float *tar_dw_f = target.tarDw_f_forUpdate(); /* NULL unless single */
+  float *dw_f = target.dw_f_forUpdate(); 
 
   int kx; 
   for (kx = 0; kx < 2; ++kx) {
@@ -467,6 +593,10 @@ void AzRgforest::_updateTarget_OtherLoss(const AzRgfTree *tree,
       AzLosses o = AzLoss::getLosses(loss_type, p[dx], y[dx], py_adjust); 
       dw[dx] = o.loss2; 
       tar_dw[dx] = o._loss1;  
+      if (tar_dw_f != NULL) {
+        dw_f[dx] = (float)dw[dx]; 
+        tar_dw_f[dx] = (float)tar_dw[dx]; 
+      }
     }
   }
 }
@@ -483,6 +613,7 @@ void AzRgforest::_updateTarget_LS(const AzRgfTree *tree,
 {
   double *r = target->tarDw_forUpdate()->point_u(); 
   double *p = v_p->point_u(); 
+  float *r_f = target->tarDw_f_forUpdate(); /* NULL unless single */
 
   int kx; 
   for (kx = 0; kx < 2; ++kx) {
@@ -499,6 +630,7 @@ void AzRgforest::_updateTarget_LS(const AzRgfTree *tree,
         p[dx] += w_inc; 
         r[dx] -= w_inc; 
       }
+      if (r_f != NULL) r_f[dx] = (float)r[dx]; 
     }
   }
 }
@@ -522,6 +654,7 @@ void AzRgforest::resetTarget()
                           &py_adjust, 
                           v_tar_dw, /* -L' */
                           v_dw);  /* L'' */
+  target.sync_single(); 
 
   if (!out.isNull() && AzLoss::isExpoFamily(loss_type)) {
     show_forExpoFamily(v_dw); 
@@ -564,8 +697,13 @@ AzRgforest::apply(AzTETrainer_TestData *td,
   }
   else {
     AzTimeLog::print("Testing ... ", out); 
-    opt->apply(test_data, b_test_tran, ens, v_test_p, /* prediction */
-               &f_num, &nz_f_num);    /*info */
+    /*---  update the prediction kept in td by what changed since the last test  ---*/
+    AzDvect *v_kept_p = AzTETrainer::_v(td); 
+    opt->apply_incr(test_data, b_test_tran, 
+                    AzTETrainer::_w(td), AzTETrainer::_c(td), ens, 
+                    v_kept_p, /* prediction */
+                    &f_num, &nz_f_num);    /*info */
+    v_test_p->set(v_kept_p); 
     if (out_ens != NULL) {
       ens->copy_to(out_ens, s_config.c_str(), signature()); 
     }
@@ -704,6 +842,16 @@ int AzRgforest::resetParam(AzParam &p)
 
   p.swOn(&doPassiveRoot, kw_doPassiveRoot); 
 
+  /*---  multi-threading  ---*/
+  p.vInt(kw_num_threads, &num_threads); 
+  if (num_threads < 0) {
+    throw new AzException(AzInputNotValid, eyec, kw_num_threads, 
+                          "must be non-negative"); 
+  }
+  threads.reset(num_threads); 
+
+  doSingle = AzOptOnTree::readPrecision(p, &s_precision); /* shared with optimizer */
+
   /*---  for maintenance purposes  ---*/
   p.swOn(&doForceToRefreshAll, kw_doForceToRefreshAll); 
   p.swOn(&beVerbose, kw_forest_beVerbose); /* for compatibility */
@@ -729,6 +877,8 @@ int AzRgforest::resetParam(AzParam &p)
     o.printV(kw_f_ratio, f_ratio); 
     o.printV(kw_random_seed, random_seed); 
     o.printSw(kw_doPassiveRoot, doPassiveRoot); 
+    o.printV(kw_num_threads, threads.threadNum()); 
+    o.printV_if_not_empty(kw_precision, s_precision); 
     o.ppEnd(); 
   }
 
@@ -761,6 +911,8 @@ void AzRgforest::printHelp(AzHelp &h) const
   h.item_experimental(kw_temp_for_trees, help_temp_for_trees); 
   h.item_experimental(kw_f_ratio, help_f_ratio); 
   h.item_experimental(kw_doPassiveRoot, help_doPassiveRoot); 
+  h.item(kw_num_threads, help_num_threads, num_threads_dflt); 
+  h.item(kw_precision, help_precision, prec_double); 
   h.end(); 
 
   reg_depth->printHelp(h);  
@@ -27,6 +27,7 @@
 #include "AzTETrainer.hpp"
 #include "AzTrTtarget.hpp"
 #include "AzTimer.hpp"
+#include "AzThreads.hpp"
 
 #include "AzRgf_Optimizer.hpp"
 #include "AzRgf_Optimizer_Dflt.hpp"
@@ -71,6 +72,11 @@ protected:
   double f_ratio; 
   int f_pick; 
   bool doPassiveRoot; 
+  int num_threads; 
+  AzThreads threads; 
+  AzBytArr s_precision; 
+  bool doSingle; /* precision=single */
+  bool doRejectUnknownParam; /* unknown parameters are an error, not a warning */
 
   /*---  work area  ---*/
   int l_num; 
@@ -86,6 +92,7 @@ protected:
   static const int max_lnum_dflt = 10000; 
   static const int lnum_inc_test_dflt = 500; 
   static const int s_tree_num_dflt = 1; 
+  static const int num_threads_dflt = 1; 
   static const AzLossType loss_type_dflt = AzLoss_Square; 
 
 public:
@@ -98,7 +105,8 @@ public:
     opt_time(0), search_time(0), doTime(false), 
     beTight(false), s_mem_policy(mp_not_beTight), 
     f_ratio(-1), f_pick(-1), 
-    doPassiveRoot(false) 
+    doPassiveRoot(false), num_threads(num_threads_dflt), doSingle(false), 
+    doRejectUnknownParam(false) 
   {
     opt = &dflt_opt; 
     ens = &dflt_ens; 
@@ -152,6 +160,10 @@ public:
     return "Regularized greedy forest"; 
   }
 
+  virtual void rejectUnknownParam(bool doReject) {
+    doRejectUnknownParam = doReject; 
+  }
+
 protected:
   /*----------------------------------------------------------------*/
   /* override this if replacing trees and if that affects optimizer */
@@ -213,12 +225,28 @@ protected:
 
   /*---  for search  ---*/
   virtual void searchBestSplit(AzTrTsplit *best_split); 
+  virtual bool searchBestSplit_parallel(const AzRgf_FindSplit_input &input, 
+                             int my_first, int last_tx, 
+                             bool doRefreshAll, 
+                             /*---  output  ---*/
+                             AzTrTsplit *best_split); 
 
   /*----*/
   bool shouldExit(const AzTrTsplit *best_split) const; 
 
   virtual void printHelp(AzHelp &h) const; 
   virtual int resetParam(AzParam &param); /* returns max #tree */
+  virtual void checkParam(AzParam &az_param, const char *eyec) const {
+    if (!doRejectUnknownParam) {
+      az_param.check(out); 
+      return; 
+    }
+    AzBytArr s_unknown; 
+    az_param.check(out, &s_unknown); 
+    if (s_unknown.length() > 0) {
+      throw new AzException(AzInputNotValid, eyec, "Unknown parameter:", s_unknown.c_str()); 
+    }
+  }
   int adjustTestInterval(int lnum_inc_test, int lnum_inc_opt); 
 
   virtual void show_tree_info() const; 
@@ -49,6 +49,77 @@ void AzSortedFeat_Dense::reset(const AzDvect *v_data_transpose,
   index = ia_index.point(&index_num); 
   offset = 0; 
   isOriginal = true; /* This is the original one.  Don't change. */
+  make_groups(); 
+}
+
+/*------------------------------------------------------*/
+/* number the distinct values of the sorted indexes     */
+/*------------------------------------------------------*/
+void AzSortedFeat_Dense::make_groups()
+{
+  const double *dx2value = v_dx2v->point(); 
+  ia_grp.reset(index_num, 0); 
+  int *my_grp = ia_grp.point_u(); 
+  int gnum = 0; 
+  int ix; 
+  for (ix = 0; ix < index_num; ++ix) {
+    if (ix == 0 || dx2value[index[ix]] != dx2value[index[ix-1]]) {
+      ++gnum; 
+    }
+    my_grp[ix] = gnum - 1; 
+  }
+  v_gval.reform(gnum); 
+  double *my_gval = v_gval.point_u(); 
+  for (ix = 0; ix < index_num; ++ix) {
+    if (ix == 0 || my_grp[ix] != my_grp[ix-1]) {
+      my_gval[my_grp[ix]] = dx2value[index[ix]]; 
+    }
+  }
+  grp = my_grp; 
+  gval = v_gval.point(); 
+}
+
+/*------------------------------------------------------*/
+void AzSortedFeat_Dense::write(AzFile *file)
+{
+  if (!isOriginal) {
+    throw new AzException("AzSortedFeat_Dense::write", "Only the original can be saved"); 
+  }
+  ia_index.write(file); 
+}
+
+/*------------------------------------------------------*/
+void AzSortedFeat_Dense::read(AzFile *file, 
+                              const AzDvect *v_data_transpose)
+{
+  const char *eyec = "AzSortedFeat_Dense::read"; 
+  ia_index.read(file); 
+  v_dx2v = v_data_transpose; 
+  int data_num = v_dx2v->rowNum(); 
+  index = ia_index.point(&index_num); 
+  if (index_num != data_num) {
+    throw new AzException(AzInputError, eyec, "#data mismatch", file->pointFileName()); 
+  }
+  /*---  must be what reset() makes: sorted by (value, index)  ---*/
+  /*---  with no duplicate, i.e., a permutation                   ---*/
+  const double *dx2value = v_dx2v->point(); 
+  int ix; 
+  for (ix = 0; ix < index_num; ++ix) {
+    int dx = index[ix]; 
+    if (dx < 0 || dx >= data_num) {
+      throw new AzException(AzInputError, eyec, "index is out of range", file->pointFileName()); 
+    }
+    if (ix > 0) {
+      int prev_dx = index[ix-1]; 
+      if (dx2value[prev_dx] > dx2value[dx] || 
+          (dx2value[prev_dx] == dx2value[dx] && prev_dx >= dx)) {
+        throw new AzException(AzInputError, eyec, "indexes are not sorted", file->pointFileName()); 
+      }
+    }
+  }
+  offset = 0; 
+  isOriginal = true; /* This is the original one.  Don't change. */
+  make_groups(); 
 }
 
 /*------------------------------------------------------*/
@@ -56,20 +127,22 @@ void AzSortedFeat_Dense::filter(const AzSortedFeat_Dense *inp,
                           const AzIntArr *ia_isYes, 
                           int yes_num)
 {
+  ia_index.reset(); 
   ia_index.prepare(yes_num); 
+  ia_grp.reset(); 
+  ia_grp.prepare(yes_num); 
   v_dx2v = inp->v_dx2v; 
+  gval = inp->gval; 
 
   int max_dx = ia_isYes->size() - 1; 
   const int *isYes = ia_isYes->point(); 
 
-  int inp_index_num; 
-  const int *inp_index = inp->ia_index.point(&inp_index_num); 
-
   int ix; 
-  for (ix = 0; ix < inp_index_num; ++ix) {
-    int dx = inp_index[ix]; 
+  for (ix = 0; ix < inp->index_num; ++ix) {
+    int dx = inp->index[ix]; 
     if (dx <= max_dx && isYes[dx]) {
       ia_index.put(dx); 
+      ia_grp.put(inp->grp[ix]); 
     }
   }
 
@@ -79,21 +152,58 @@ void AzSortedFeat_Dense::filter(const AzSortedFeat_Dense *inp,
   offset = 0; /* 04/06/2012 */
 #endif 
   index = ia_index.point(&index_num); 
+  grp = ia_grp.point(); 
+}
+
+/*------------------------------------------------------*/
+void AzSortedFeat_Dense::copy_indexes(const AzIntArr *ia_isYes, /* may be NULL */
+                                      int *out, int *out_grp, int out_num)
+const
+{
+  const char *eyec = "AzSortedFeat_Dense::copy_indexes"; 
+  if (ia_isYes == NULL) {
+    if (out_num != index_num) {
+      throw new AzException(eyec, "Conflict in # of data points"); 
+    }
+    memcpy(out, index, sizeof(int)*index_num); 
+    memcpy(out_grp, grp, sizeof(int)*index_num); 
+    return; 
+  }
+
+  int max_dx = ia_isYes->size() - 1; 
+  const int *isYes = ia_isYes->point(); 
+  int num = 0; 
+  int ix; 
+  for (ix = 0; ix < index_num; ++ix) {
+    int dx = index[ix]; 
+    if (dx <= max_dx && isYes[dx]) {
+      if (num >= out_num) break; 
+      out[num] = dx; 
+      out_grp[num] = grp[ix]; 
+      ++num; 
+    }
+  }
+  if (num != out_num) {
+    throw new AzException(eyec, "Conflict in # of yes's"); 
+  }
 }
 
 /*------------------------------------------------------*/
 /* place indexes so that yes's first and no's last and  */
-/* the order with yes's and no's does not change.       */
+/* the order with yes's and no's does not change; the   */
+/* value#'s move with the indexes.                      */
 /*------------------------------------------------------*/
 /* static */
 void AzSortedFeat_Dense::separate_indexes(int *index, 
+                           int *grp, 
                            int index_num, 
                            const int *isYes, 
                            int yes_num, 
-                           int max_dx)
+                           int max_dx, 
+                           int *work) /* size: (index_num-yes_num)*2 */
 {
-  AzIntArr ia_no;  
-  ia_no.prepare(index_num-yes_num); 
+  int *work_grp = work + (index_num-yes_num); 
+  int no_num = 0; 
   int yes_ix = 0; 
   int ix; 
   for (ix = 0; ix < index_num; ++ix) {
@@ -101,85 +211,26 @@ void AzSortedFeat_Dense::separate_indexes(int *index,
     if (dx <= max_dx && isYes[dx]) {
       if (yes_ix != ix) {
         index[yes_ix] = dx; 
+        grp[yes_ix] = grp[ix]; 
       }
       ++yes_ix; 
     }
     else {
-      ia_no.put(dx); 
+      if (no_num >= index_num-yes_num) break; 
+      work_grp[no_num] = grp[ix]; 
+      work[no_num++] = dx; 
     }
   }
-
-  if (ia_no.size() > 0) {
-    memcpy(index+yes_ix, ia_no.point(), sizeof(int)*ia_no.size()); 
-  }
-  if (yes_ix != yes_num) {
+  if (yes_ix != yes_num || no_num != index_num-yes_num) {
     throw new AzException("AzSortedFeat_Dense::separate_indexes", 
                           "conflict in # of yes's"); 
   }
-}
-
-/*------------------------------------------------------*/
-void AzSortedFeat_Dense::separate(
-                          AzSortedFeat_Dense *base,  
-                          const AzSortedFeat_Dense *inp, 
-                          const AzIntArr *ia_isYes, 
-                          int yes_num, 
-                          AzSortedFeat_Dense *yes, 
-                          AzSortedFeat_Dense *no)
-{
-  const char *eyec = "AzSortedFeat_Dense::separate"; 
-
-  yes->v_dx2v = inp->v_dx2v; 
-  no->v_dx2v = inp->v_dx2v; 
-
-  int max_dx = ia_isYes->size() - 1; 
-  const int *isYes = ia_isYes->point(); 
-
-  int base_index_num; 
-  int *base_index = base->base_index_for_update(&base_index_num); 
-
-  int *sub_index = base_index + inp->offset; 
-
-  if (inp->index != sub_index || 
-      inp->offset+inp->index_num > base_index_num) {
-    throw new AzException(eyec, "index conflict"); 
-  }
-
-  separate_indexes(sub_index, inp->index_num, 
-                   isYes, yes_num, max_dx); 
-
-  yes->index = sub_index; 
-  yes->index_num = yes_num; 
-  yes->offset = inp->offset; 
-  no->index = sub_index + yes_num; 
-  no->index_num = inp->index_num - yes_num; 
-  no->offset = inp->offset + yes_num; 
-
-  if (base_index+yes->offset != yes->index || 
-      base_index+no->offset != no->index) {
-    throw new AzException(eyec, "conflict in pointers"); 
+  if (no_num > 0) {
+    memcpy(index+yes_ix, work, sizeof(int)*no_num); 
+    memcpy(grp+yes_ix, work_grp, sizeof(int)*no_num); 
   }
 }
 
-/*------------------------------------------------------*/
-void AzSortedFeat_Dense::copy_base(const AzSortedFeat_Dense *inp)
-{
-  if (inp->ia_index.size() <= 0 || 
-      inp->index != inp->ia_index.point() || 
-      inp->index_num != inp->ia_index.size() || 
-      inp->offset != 0) {
-    throw new AzException("AzSortedFeat_Dense::copy_base", 
-                          "Expected the base as input"); 
-  }
-
-  ia_index.reset(&inp->ia_index); 
-  v_dx2v = inp->v_dx2v; 
-  index = ia_index.point(&index_num); 
-  offset = 0; 
-
-  isOriginal = false; /* This is a copy. */
-}
-
 /* called when and only when data points are sampled */
 /*--------------------------------------------------------*/
 void AzSortedFeatArr::filter_base(const AzSortedFeatArr *inp, 
@@ -191,6 +242,7 @@ void AzSortedFeatArr::filter_base(const AzSortedFeatArr *inp,
   f_num = inp->featNum(); 
   a_sparse.free(&arrs); 
   a_dense.free(&arrd); 
+  reset_part(); 
 
   ia_isActive.reset(); 
   ia_isActive.toOnOff(dxs, dxs_num); 
@@ -200,25 +252,16 @@ void AzSortedFeatArr::filter_base(const AzSortedFeatArr *inp,
     return; 
   }
 
-  if (inp->doingSparse()) {
+  if (inp->arrs != NULL) {
     a_sparse.alloc(&arrs, f_num, eyec, "arrs"); 
     int fx; 
     for (fx = 0; fx < f_num; ++fx) {
-      if (inp->arrs == NULL || inp->arrs[fx] == NULL) {
-        throw new AzException(eyec, "No sorted sparse features?!");
-      }
+      if (inp->arrs[fx] == NULL) continue; /* dense */
       arrs[fx] = new AzSortedFeat_Sparse(inp->arrs[fx], &ia_isActive, active_num); 
     }
   }
-  else {
-    a_dense.alloc(&arrd, f_num, eyec, "arrd"); 
-    int fx; 
-    for (fx = 0; fx < f_num; ++fx) {
-      if (inp->arrd == NULL || inp->arrd[fx] == NULL) {
-        throw new AzException(eyec, "No sorted dense features?!");
-      }
-      arrd[fx] = new AzSortedFeat_Dense(inp->arrd[fx], &ia_isActive, active_num); 
-    }
+  if (inp->arrd != NULL) {
+    make_part(inp, &ia_isActive, active_num); 
   }
 }
 
@@ -234,31 +277,17 @@ const
     return NULL;  /* end of data */
   }
 
-  const double *dx2value = v_dx2v->point(); 
-
-  int dx = index[cursor]; 
-  double curr_val = dx2value[dx]; 
-
   int begin = cursor; 
-  cursor = cur.inc(); 
-  if (cursor >= index_num) {
-    return  NULL; /* this will produce all vs none anyway */
-  }
-
-  double avg_val = curr_val + 0.00000001; 
-  for ( ; cursor < index_num; cursor=cur.inc()) {
-    int dx = index[cursor]; 
-    double next_val = dx2value[dx]; 
-    if (next_val != curr_val) {
-      avg_val = (curr_val + next_val) / 2; 
-      break; 
-    }
+  int curr_grp = grp[cursor]; 
+  for (++cursor; cursor < index_num; ++cursor) {
+    if (grp[cursor] != curr_grp) break; 
   }
+  cur.set(cursor); 
   if (cursor >= index_num) {
     return NULL; /* this will produce all vs none anyway */
   }
 
-  *out_val = avg_val; 
+  *out_val = (gval[curr_grp] + gval[grp[cursor]]) / 2; 
   *out_num = cursor - begin; 
   return index + begin;   
 }
@@ -277,13 +306,14 @@ const
                           "Conflict in # of data points"); 
   }
 
-  const double *dx2value = v_dx2v->point(); 
-  int ix; 
-  for (ix = 0; ix < index_num; ++ix) {
-    int dx = index[ix]; 
-    if (dx2value[dx] > border_val) break; 
+  /*---  the values are in the ascending order; find the first one > border_val  ---*/
+  int lo = 0, hi = index_num; 
+  while (lo < hi) {
+    int mid = lo + (hi-lo)/2; 
+    if (gval[grp[mid]] > border_val) hi = mid; 
+    else                             lo = mid + 1; 
   }
-  int le_size = ix; 
+  int le_size = lo; 
   ia_le_dx->reset(index, le_size); 
   ia_gt_dx->reset(index+le_size, index_num-le_size); 
 }
@@ -350,6 +380,91 @@ void AzSortedFeat_Sparse::reset(const AzSvect *v_data_transpose,
   }
 }
 
+/*------------------------------------------------------*/
+void AzSortedFeat_Sparse::write(AzFile *file)
+{
+  file->writeInt(data_num); 
+  file->writeBool(_shouldDoBackward); 
+  ia_zero.write(file); 
+  ia_index.write(file); 
+  v_value.write(file); 
+}
+
+/*------------------------------------------------------*/
+/* Check that it is what reset() makes from the column: */
+/* the nonzero ones (and AzNone for zero if any) sorted */
+/* by (value, index), and all the zero ones or none in  */
+/* ia_zero in the ascending order.                      */
+/*------------------------------------------------------*/
+void AzSortedFeat_Sparse::read(AzFile *file, 
+                               const AzSvect *v_data_transpose)
+{
+  const char *eyec = "AzSortedFeat_Sparse::read"; 
+  int inp_data_num = v_data_transpose->rowNum(); 
+  data_num = file->readInt(); 
+  _shouldDoBackward = file->readBool(); 
+  ia_zero.read(file); 
+  ia_index.read(file); 
+  v_value.read(file); 
+  if (data_num != inp_data_num || 
+      ia_zero.size() > data_num || 
+      ia_index.size() > data_num + 1 || /* +1 for the place holder for zero */
+      (ia_index.size() > 0 && v_value.rowNum() != ia_index.size())) {
+    throw new AzException(AzInputError, eyec, "size mismatch", file->pointFileName()); 
+  }
+  int nz_num = v_data_transpose->nonZeroRowNum(); 
+  int zero_num = data_num - nz_num; 
+  const int *index = ia_index.point(); 
+  const double *value = v_value.point(); 
+  int holder_ix = -1; 
+  int ix; 
+  for (ix = 0; ix < ia_index.size(); ++ix) {
+    int dx = index[ix]; 
+    if (dx == AzNone) {
+      if (holder_ix >= 0 || value[ix] != 0) {
+        throw new AzException(AzInputError, eyec, "invalid place holder for zero", file->pointFileName()); 
+      }
+      holder_ix = ix; 
+    }
+    else if (dx < 0 || dx >= data_num) {
+      throw new AzException(AzInputError, eyec, "index is out of range", file->pointFileName()); 
+    }
+    else if (value[ix] == 0 || v_data_transpose->get(dx) != value[ix]) {
+      throw new AzException(AzInputError, eyec, "value mismatch", file->pointFileName()); 
+    }
+    if (ix > 0 && (value[ix-1] > value[ix] || 
+                   (value[ix-1] == value[ix] && index[ix-1] >= dx))) {
+      throw new AzException(AzInputError, eyec, "indexes are not sorted", file->pointFileName()); 
+    }
+  }
+  if (ia_index.size() != nz_num + ((zero_num > 0) ? 1 : 0) || 
+      (zero_num > 0) != (holder_ix >= 0)) {
+    throw new AzException(AzInputError, eyec, "#nonzero mismatch", file->pointFileName()); 
+  }
+
+  if (ia_zero.size() > 0) {
+    const int *zero = ia_zero.point(); 
+    for (ix = 0; ix < ia_zero.size(); ++ix) {
+      int dx = zero[ix]; 
+      if (dx < 0 || dx >= data_num || 
+          (ix > 0 && zero[ix-1] >= dx) || 
+          v_data_transpose->get(dx) != 0) {
+        throw new AzException(AzInputError, eyec, "invalid index of zero", file->pointFileName()); 
+      }
+    }
+    if (ia_zero.size() != zero_num) {
+      throw new AzException(AzInputError, eyec, "#zero mismatch", file->pointFileName()); 
+    }
+  }
+  else if (zero_num > 0) {
+    /*---  without ia_zero, zero must be at the end where the scan starts  ---*/
+    if ((_shouldDoBackward && holder_ix != 0) || 
+        (!_shouldDoBackward && holder_ix != ia_index.size()-1)) {
+      throw new AzException(AzInputError, eyec, "misplaced zero", file->pointFileName()); 
+    }
+  }
+}
+
 /*------------------------------------------------------*/
 void AzSortedFeat_Sparse::filter(const AzSortedFeat_Sparse *inp, 
                           const AzIntArr *ia_isYes, 
@@ -698,51 +813,144 @@ const
 
 /*--------------------------------------------------------*/
 /*--------------------------------------------------------*/
-void AzSortedFeatArr::reset_sparse(const AzSmat *m_tran, 
-                            bool inp_beTight)
+/* static */
+int AzSortedFeatArr::check_input(const AzSmat *m_tran, 
+                                 const AzDmat *m_tran_dense, 
+                                 const AzIntArr *ia_fx2dense, 
+                                 int *out_dense_num) /* output */
 {
-  const char *eyec = "AzSortedFeatArr::reset_sparse"; 
-  beTight = inp_beTight; 
-  f_num = m_tran->colNum(); 
-  int data_num = m_tran->rowNum(); 
-  ia_isActive.reset(); 
-  active_num = 0; 
+  const char *eyec = "AzSortedFeatArr::check_input"; 
+  int data_num = 0; 
+  if (m_tran != NULL) {
+    data_num = m_tran->rowNum(); 
+  }
+  if (m_tran_dense != NULL) {
+    if (m_tran != NULL && m_tran_dense->rowNum() != data_num) {
+      throw new AzException(eyec, "#data mismatch between sparse and dense"); 
+    }
+    data_num = m_tran_dense->rowNum(); 
+  }
+  int dense_num = 0; 
+  const int *fx2dense = ia_fx2dense->point(); 
+  int fx; 
+  for (fx = 0; fx < ia_fx2dense->size(); ++fx) {
+    if (fx2dense[fx] >= 0) {
+      if (m_tran_dense == NULL || fx2dense[fx] >= m_tran_dense->colNum()) {
+        throw new AzException(eyec, "dense feature is out of range"); 
+      }
+      ++dense_num; 
+    }
+    else if (m_tran == NULL || fx >= m_tran->colNum()) {
+      throw new AzException(eyec, "sparse feature is out of range"); 
+    }
+  }
+  *out_dense_num = dense_num; 
+  return data_num; 
+}
 
+/*--------------------------------------------------------*/
+void AzSortedFeatArr::alloc_arr(bool doSparse, bool doDense)
+{
+  const char *eyec = "AzSortedFeatArr::alloc_arr"; 
   a_sparse.free(&arrs); 
   a_dense.free(&arrd); 
-  a_sparse.alloc(&arrs, f_num, eyec, "arrs"); 
+  if (doSparse) a_sparse.alloc(&arrs, f_num, eyec, "arrs"); 
+  if (doDense)  a_dense.alloc(&arrd, f_num, eyec, "arrd"); 
+}
+
+/*--------------------------------------------------------*/
+void AzSortedFeatArr::reset(const AzSmat *m_tran,         /* NULL if no sparse feature */
+                            const AzDmat *m_tran_dense,   /* NULL if no dense feature */
+                            const AzIntArr *ia_fx2dense, 
+                            bool inp_beTight)
+{
+  reset(); 
+  beTight = inp_beTight; 
+  f_num = ia_fx2dense->size(); 
+  int dense_num = 0; 
+  int data_num = check_input(m_tran, m_tran_dense, ia_fx2dense, &dense_num); 
+  alloc_arr(dense_num < f_num, dense_num > 0); 
 
-  int nz_num = 0; 
   AzIntArr ia_all_dx; 
   ia_all_dx.range(0, data_num); 
+  const int *fx2dense = ia_fx2dense->point(); 
   int fx; 
   for (fx = 0; fx < f_num; ++fx) {
-    arrs[fx] = new AzSortedFeat_Sparse(m_tran->col(fx), &ia_all_dx); 
+    if (fx2dense[fx] >= 0) {
+      arrd[fx] = new AzSortedFeat_Dense(m_tran_dense->col(fx2dense[fx]), &ia_all_dx); 
+    }
+    else {
+      arrs[fx] = new AzSortedFeat_Sparse(m_tran->col(fx), &ia_all_dx); 
+    }
   }
 }
 
 /*--------------------------------------------------------*/
-void AzSortedFeatArr::reset_dense(const AzDmat *m_tran_dense,   /* set */
-                                  bool inp_beTight)
+/* f_num, the type (sparse or not) of all or, if mixed,   */
+/* of each feature, and the features.                     */
+/*--------------------------------------------------------*/
+void AzSortedFeatArr::write(AzFile *file)
 {
-  const char *eyec = "AzSortedFeatArr::reset (dense)"; 
+  const char *eyec = "AzSortedFeatArr::write"; 
+  if (arrs == NULL && arrd == NULL) {
+    throw new AzException(eyec, "Nothing to write"); 
+  }
+  file->writeInt(f_num); 
+  int fx; 
+  if (arrs != NULL && arrd != NULL) {
+    for (fx = 0; fx < f_num; ++fx) {
+      file->writeBool(arrs[fx] != NULL); 
+    }
+  }
+  else {
+    file->writeBool(arrs != NULL); 
+  }
+  for (fx = 0; fx < f_num; ++fx) {
+    if (arrs != NULL && arrs[fx] != NULL) arrs[fx]->write(file); 
+    else                                  arrd[fx]->write(file); 
+  }
+}
 
+/*--------------------------------------------------------*/
+void AzSortedFeatArr::read(AzFile *file, 
+                           const AzSmat *m_tran,         /* NULL if no sparse feature */
+                           const AzDmat *m_tran_dense,   /* NULL if no dense feature */
+                           const AzIntArr *ia_fx2dense, 
+                           bool inp_beTight)
+{
+  const char *eyec = "AzSortedFeatArr::read"; 
+  reset(); 
   beTight = inp_beTight; 
-  f_num = m_tran_dense->colNum(); 
-  int data_num = m_tran_dense->rowNum(); 
-  ia_isActive.reset(); 
-  active_num = 0; 
-
-  a_sparse.free(&arrs); 
-  a_dense.free(&arrd); 
-  a_dense.alloc(&arrd, f_num, eyec, "arrd"); 
-
-  int nz_num = 0; 
-  AzIntArr ia_all_dx; 
-  ia_all_dx.range(0, data_num); 
+  int dense_num = 0; 
+  check_input(m_tran, m_tran_dense, ia_fx2dense, &dense_num); 
+  const int *fx2dense = ia_fx2dense->point(); 
+  int file_f_num = file->readInt(); 
+  bool isMatched = (file_f_num == ia_fx2dense->size()); 
   int fx; 
+  if (isMatched && dense_num > 0 && dense_num < file_f_num) {
+    for (fx = 0; fx < file_f_num; ++fx) {
+      bool isSparse = file->readBool(); 
+      if (isSparse != (fx2dense[fx] < 0)) isMatched = false; 
+    }
+  }
+  else if (isMatched) {
+    bool isSparse = file->readBool(); 
+    if (isSparse != (dense_num == 0)) isMatched = false; 
+  }
+  if (!isMatched) {
+    throw new AzException(AzInputError, eyec, "#feat or type mismatch", file->pointFileName()); 
+  }
+  f_num = file_f_num; 
+  alloc_arr(dense_num < f_num, dense_num > 0); 
   for (fx = 0; fx < f_num; ++fx) {
-    arrd[fx] = new AzSortedFeat_Dense(m_tran_dense->col(fx), &ia_all_dx); 
+    if (fx2dense[fx] >= 0) {
+      arrd[fx] = new AzSortedFeat_Dense(); 
+      arrd[fx]->read(file, m_tran_dense->col(fx2dense[fx])); 
+    }
+    else {
+      arrs[fx] = new AzSortedFeat_Sparse(); 
+      arrs[fx]->read(file, m_tran->col(fx)); 
+    }
   }
 }
 
@@ -754,6 +962,7 @@ void AzSortedFeatArr::copy_base(const AzSortedFeatArr *inp)
   f_num = inp->featNum(); 
   a_sparse.free(&arrs); 
   a_dense.free(&arrd); 
+  reset_part(); 
 
   ia_isActive.reset(); 
   active_num = 0; 
@@ -762,58 +971,107 @@ void AzSortedFeatArr::copy_base(const AzSortedFeatArr *inp)
     return; 
   }
 
-  if (inp->doingSparse()) {
+  int fx; 
+  if (inp->arrs != NULL) {
     a_sparse.alloc(&arrs, f_num, eyec, "arrs"); 
-    int fx; 
     for (fx = 0; fx < f_num; ++fx) {
-      if (inp->arrs == NULL || inp->arrs[fx] == NULL) {
-        throw new AzException(eyec, "No sorted sparse features?!");
-      }
+      if (inp->arrs[fx] == NULL) continue; /* dense */
       arrs[fx] = new AzSortedFeat_Sparse(inp->arrs[fx]); 
     }
   }
-  else {
-    a_dense.alloc(&arrd, f_num, eyec, "arrd"); 
-    int fx; 
+  if (inp->arrd != NULL) {
+    int data_num = 0; 
     for (fx = 0; fx < f_num; ++fx) {
-      if (inp->arrd == NULL || inp->arrd[fx] == NULL) {
-        throw new AzException(eyec, "No sorted dense features?!");
+      if (inp->arrd[fx] != NULL) {
+        data_num = inp->arrd[fx]->dataNum(); 
+        break; 
       }
-      arrd[fx] = new AzSortedFeat_Dense(inp->arrd[fx]); 
     }
+    make_part(inp, NULL, data_num); 
   }
 }
 
+/*--------------------------------------------------------*/
+/* Copy the sorted indexes of all the dense features to   */
+/* one buffer; this is the base, and the nodes below are  */
+/* segments of it (see separate_part).                    */
+/*--------------------------------------------------------*/
+void AzSortedFeatArr::make_part(const AzSortedFeatArr *inp, 
+                                const AzIntArr *ia_isYes, /* may be NULL */
+                                int num)
+{
+  const char *eyec = "AzSortedFeatArr::make_part"; 
+  reset_part(); 
+  if (inp->arrd == NULL || inp->part_base != NULL) {
+    throw new AzException(eyec, "Expected the original dense sorted features"); 
+  }
+  ia_fx2part.reset(f_num, -1); 
+  int *fx2part = ia_fx2part.point_u(); 
+  part_fnum = 0; 
+  int fx; 
+  for (fx = 0; fx < f_num; ++fx) {
+    if (inp->arrd[fx] != NULL) {
+      fx2part[fx] = part_fnum++; 
+    }
+    else if (inp->arrs == NULL || inp->arrs[fx] == NULL) {
+      throw new AzException(eyec, "No sorted features?!"); 
+    }
+  }
+
+  part_stride = num; 
+  if (ia_part.size() != part_fnum*part_stride) { /* else reuse it */
+    ia_part.reset(part_fnum*part_stride, -1); 
+    ia_part_grp.reset(part_fnum*part_stride, -1); 
+  }
+  int *part = ia_part.point_u(); 
+  int *part_grp = ia_part_grp.point_u(); 
+  for (fx = 0; fx < f_num; ++fx) {
+    if (fx2part[fx] < 0) continue; /* sparse */
+    int pos = fx2part[fx]*part_stride; 
+    inp->arrd[fx]->copy_indexes(ia_isYes, part+pos, part_grp+pos, part_stride); 
+  }
+  part_base = this; 
+  part_org = inp; 
+  part_offset = 0; 
+  part_num = part_stride; 
+}
+
 /*--------------------------------------------------------*/
 /*
- *  called when beTight is on. 
+ *  called when beTight is on or the indexes are partitioned. 
  */
 const AzSortedFeat *AzSortedFeatArr::sorted(const AzSortedFeatArr *inp, 
                              int fx, 
                              AzSortedFeatWork *out) const 
 {
   const char *eyec = "AzSortedFeatArr::sorted(inp,fx,work0)"; 
-  if (f_num != inp->featNum() || 
-      ia_isActive.size() <= 0 || active_num <= 0) {
-    throw new AzException(eyec, "not ready?!"); 
-  }
   if (fx < 0 || fx >= f_num) {
     throw new AzException(eyec, "out of range"); 
   }
-  if (inp->doingSparse()) {
-    if (inp->arrs == NULL || inp->arrs[fx] == NULL) {
-      throw new AzException(eyec, "Expected sparse sorted features as input"); 
+  if (part_base != NULL) {
+    int px = part_base->ia_fx2part.get(fx); 
+    if (px < 0) {
+      throw new AzException(eyec, "Expected a dense feature"); 
     }
+    int pos = px*part_base->part_stride + part_offset; 
+    out->tmpd.reset_view(part_org->arrd[fx], 
+                 part_base->ia_part.point()+pos, part_base->ia_part_grp.point()+pos, 
+                 part_num); 
+    return &out->tmpd; 
+  }
+  if (f_num != inp->featNum() || 
+      ia_isActive.size() <= 0 || active_num <= 0) {
+    throw new AzException(eyec, "not ready?!"); 
+  }
+  if (inp->arrs != NULL && inp->arrs[fx] != NULL) {
     out->tmps.filter(inp->arrs[fx], &ia_isActive, active_num); 
     return &out->tmps; 
   }
-  else {
-    if (inp->arrd == NULL || inp->arrd[fx] == NULL) {
-      throw new AzException(eyec, "Expected dense sorted features as input"); 
-    }
+  if (inp->arrd != NULL && inp->arrd[fx] != NULL) {
     out->tmpd.filter(inp->arrd[fx], &ia_isActive, active_num); 
     return &out->tmpd; 
   }
+  throw new AzException(eyec, "No sorted feature given as input"); 
 }
 
 /*--------------------------------------------------------*/
@@ -826,15 +1084,12 @@ void AzSortedFeatArr::sub_initialize(const AzSortedFeatArr *inp,
   ptr->f_num = inp->featNum(); 
   ptr->a_sparse.free(&ptr->arrs);
   ptr->a_dense.free(&ptr->arrd); 
+  ptr->reset_part(); 
 
-  if (!inp->beTight) {
+  /*---  dense features are segments of the base  ---*/
+  if (!inp->beTight && inp->arrs != NULL) {
     const char *eyec = "AzSortedFeatArr::sub_initialize"; 
-    if (inp->doingSparse()) {
-      ptr->a_sparse.alloc(&ptr->arrs, ptr->f_num, eyec, "arrs"); 
-    }
-    else {
-      ptr->a_dense.alloc(&ptr->arrd, ptr->f_num, eyec, "arrd");
-    }
+    ptr->a_sparse.alloc(&ptr->arrs, ptr->f_num, eyec, "arrs"); 
   }
 }
 
@@ -862,12 +1117,10 @@ void AzSortedFeatArr::separate(AzSortedFeatArr *base, /* used only by Dense */
     return; 
   }
 
-  if (inp->doingSparse()) {
+  if (inp->arrs != NULL) {
     int fx; 
     for (fx = 0; fx < inp->featNum(); ++fx) {
-      if (inp->arrs == NULL || inp->arrs[fx] == NULL) {
-        throw new AzException(eyec, "No sparse sorted featuers given as input"); 
-      }
+      if (inp->arrs[fx] == NULL) continue; /* dense */
       yes->arrs[fx] = new AzSortedFeat_Sparse(); 
       no->arrs[fx] = new AzSortedFeat_Sparse(); 
       AzSortedFeat_Sparse::separate(inp->arrs[fx], &ia_isActive, active_num,  
@@ -878,27 +1131,55 @@ void AzSortedFeatArr::separate(AzSortedFeatArr *base, /* used only by Dense */
       }
     }
   }
-  else {
-    if (base == NULL) {
-      throw new AzException(eyec, "base is null.  something is wrong"); 
+  if (inp->arrd != NULL || inp->part_base != NULL) {
+    if (base == NULL || inp->part_base != base) {
+      throw new AzException(eyec, "Expected a segment of the base as input"); 
     }
-    int fx; 
-    for (fx = 0; fx < inp->featNum(); ++fx) {
-      if (base->arrd == NULL || base->arrd[fx] == NULL) {
-        throw new AzException(eyec, "No dense sorted featuers given as base"); 
-      }
-      if (inp->arrd == NULL || inp->arrd[fx] == NULL) {
-        throw new AzException(eyec, "No dense sorted featuers given as input"); 
-      }
-      yes->arrd[fx] = new AzSortedFeat_Dense(); 
-      no->arrd[fx] = new AzSortedFeat_Dense(); 
-      AzSortedFeat_Dense::separate(base->arrd[fx], 
-                               inp->arrd[fx], &ia_isActive, active_num,  
-                               yes->arrd[fx], no->arrd[fx]); 
-      if (yes->arrd[fx]->dataNum() != yes_dxs_num || 
-          no->arrd[fx]->dataNum() != no_dxs_num) {
-        throw new AzException(eyec, "conflict in pop (dense)"); 
-      }
+    base->separate_part(inp, &ia_isActive, active_num, yes, no); 
+    if (yes->part_num != yes_dxs_num || no->part_num != no_dxs_num) {
+      throw new AzException(eyec, "conflict in pop (dense)"); 
     }
   }
 }
+
+/*--------------------------------------------------------*/
+/* Separate inp's segment of the buffer in place for all  */
+/* the dense features: yes's first and no's last, keeping */
+/* the order within each; no allocation per node or       */
+/* feature.                                               */
+/*--------------------------------------------------------*/
+void AzSortedFeatArr::separate_part(const AzSortedFeatArr *inp, 
+                                    const AzIntArr *ia_isYes, 
+                                    int yes_num, 
+                                    AzSortedFeatArr *yes, 
+                                    AzSortedFeatArr *no) 
+{
+  const char *eyec = "AzSortedFeatArr::separate_part"; 
+  if (part_base != this || 
+      inp->part_offset < 0 || inp->part_offset+inp->part_num > part_stride || 
+      yes_num < 0 || yes_num > inp->part_num) {
+    throw new AzException(eyec, "index conflict"); 
+  }
+  int no_num = inp->part_num - yes_num; 
+  if (ia_part_work.size() < no_num*2) {
+    ia_part_work.reset(no_num*2, 0); 
+  }
+  int *work = ia_part_work.point_u(); 
+  int *part = ia_part.point_u(); 
+  int *part_grp = ia_part_grp.point_u(); 
+  int max_dx = ia_isYes->size() - 1; 
+  const int *isYes = ia_isYes->point(); 
+  int px; 
+  for (px = 0; px < part_fnum; ++px) {
+    int pos = px*part_stride + inp->part_offset; 
+    AzSortedFeat_Dense::separate_indexes(part+pos, part_grp+pos, 
+                         inp->part_num, isYes, yes_num, max_dx, work); 
+  }
+
+  yes->part_base = no->part_base = this; 
+  yes->part_org = no->part_org = part_org; 
+  yes->part_offset = inp->part_offset; 
+  yes->part_num = yes_num; 
+  no->part_offset = inp->part_offset + yes_num; 
+  no->part_num = no_num; 
+}
@@ -38,6 +38,15 @@ public:
                               AzIntArr *ia_gt_dx) const = 0; 
 }; 
 
+//! Data points sorted by feature values, with the values inline.  
+/**
+  *  Next to each index is the number of its distinct value (0,1,...  
+  *  in the ascending order of the values), which stays with the index 
+  *  when the indexes are filtered or partitioned.  So the scan for the 
+  *  next distinct value compares the numbers in order and looks up the 
+  *  value table only at the borders, instead of the value of every data 
+  *  point through its index.  
+ **/
 class AzSortedFeat_Dense : public virtual AzSortedFeat
 {
 protected:
@@ -48,43 +57,58 @@ protected:
   const AzDvect *v_dx2v; 
   bool isOriginal; 
 
+  AzIntArr ia_grp;     /* distinct value# of each index */
+  const int *grp;      /* [index_num]; ascending */
+  AzDvect v_gval;      /* original only: distinct values in the ascending order */
+  const double *gval;  /* of the original */
+
 public:
   AzSortedFeat_Dense() : v_dx2v(NULL), index(NULL), index_num(0), 
-                         offset(-1), isOriginal(false) {}
+                         offset(-1), isOriginal(false), grp(NULL), gval(NULL) {}
   AzSortedFeat_Dense(const AzDvect *v_data_transpose, 
                      const AzIntArr *ia_dx) 
                        : v_dx2v(NULL), index(NULL), index_num(0), 
-                         offset(-1), isOriginal(false) {
+                         offset(-1), isOriginal(false), grp(NULL), gval(NULL) {
     reset(v_data_transpose, ia_dx); 
   }
   AzSortedFeat_Dense(const AzSortedFeat_Dense *inp,  /* must not be NULL */
                const AzIntArr *ia_isYes,    
                int yes_num)
                        : v_dx2v(NULL), index(NULL), index_num(0), 
-                         offset(-1), isOriginal(false) {
+                         offset(-1), isOriginal(false), grp(NULL), gval(NULL) {
     filter(inp, ia_isYes, yes_num); 
   }
-  AzSortedFeat_Dense(const AzSortedFeat_Dense *inp)
-                       : v_dx2v(NULL), index(NULL), index_num(0), 
-                         offset(-1), isOriginal(false) {
-    copy_base(inp); 
-  }
 
   void reset(const AzDvect *v_data_transpose, const AzIntArr *ia_dx); 
   void filter(const AzSortedFeat_Dense *inp,
               const AzIntArr *ia_isYes,
               int yes_num); 
 
-  inline int dataNum() const {
-    return index_num; 
+  /*---  to look at a segment of AzSortedFeatArr's partitioned indexes  ---*/
+  inline void reset_view(const AzSortedFeat_Dense *org, 
+                         const int *inp_index, const int *inp_grp, 
+                         int inp_index_num) {
+    ia_index.reset(); 
+    ia_grp.reset(); 
+    v_dx2v = org->v_dx2v; 
+    gval = org->gval; 
+    index = inp_index; 
+    grp = inp_grp; 
+    index_num = inp_index_num; 
+    offset = -1; 
+    isOriginal = false; 
   }
+  /*---  write the indexes of ia_isYes (all if NULL) and their value#'s  ---*/
+  /*---  to out[0..out_num-1] and out_grp[0..out_num-1]                  ---*/
+  void copy_indexes(const AzIntArr *ia_isYes, /* may be NULL */
+                    int *out, int *out_grp, int out_num) const; 
 
-  inline int *base_index_for_update(int *len) {
-    if (isOriginal) {
-      throw new AzException("AzSortedFeat_Dense::base_index_for_update", 
-                            "Not allowed"); 
-    }
-    return ia_index.point_u(len); 
+  /*---  save/restore what reset() made  ---*/
+  void write(AzFile *file); 
+  void read(AzFile *file, const AzDvect *v_data_transpose); 
+
+  inline int dataNum() const {
+    return index_num; 
   }
 
   inline void rewind(AzCursor &cur) const {
@@ -99,7 +123,11 @@ public:
   AzSortedFeat_Dense & operator =(const AzSortedFeat_Dense &inp) { /* never tested */
     if (this == &inp) return *this; 
     ia_index.reset(&inp.ia_index); 
+    ia_grp.reset(&inp.ia_grp); 
     v_dx2v = inp.v_dx2v; 
+    gval = inp.gval; 
+    index = ia_index.point(&index_num); 
+    grp = ia_grp.point(); 
     return *this; 
   }
 
@@ -109,21 +137,16 @@ public:
                               AzIntArr *ia_le_dx, 
                               AzIntArr *ia_gt_dx) const; 
 
-  static void separate(AzSortedFeat_Dense *base, /* indexes will be swaped */
-                       const AzSortedFeat_Dense *inp, 
-                       const AzIntArr *isYes, 
-                       int yes_num, 
-                       AzSortedFeat_Dense *yes, 
-                       AzSortedFeat_Dense *no); 
-
-protected:
-  void copy_base(const AzSortedFeat_Dense *inp); 
-
   static void separate_indexes(int *index, 
+                           int *grp, 
                            int index_num, 
                            const int *isYes, 
                            int yes_num, 
-                           int max_dx); 
+                           int max_dx, 
+                           int *work); /* size: (index_num-yes_num)*2 */
+
+protected:
+  void make_groups(); 
 }; 
 
 
@@ -165,6 +188,10 @@ public:
               const AzIntArr *ia_isYes, 
               int yes_num); 
 
+  /*---  save/restore what reset() made  ---*/
+  void write(AzFile *file); 
+  void read(AzFile *file, const AzSvect *v_data_transpose); 
+
   inline void rewind(AzCursor &cur) const {
     if (_shouldDoBackward) {
       cur.set(ia_index.size()); 
@@ -230,10 +257,11 @@ public:
   AzSortedFeat_Dense tmpd; 
 }; 
 
+//! Sorted features of all; each feature is either sparse or dense.  
 class AzSortedFeatArr { 
 protected:
-  AzSortedFeat_Sparse **arrs; 
-  AzSortedFeat_Dense **arrd; 
+  AzSortedFeat_Sparse **arrs; /* NULL if no sparse feature; [fx] is NULL for dense */
+  AzSortedFeat_Dense **arrd;  /* NULL if no dense feature; [fx] is NULL for sparse */
   AzObjPtrArray<AzSortedFeat_Sparse> a_sparse; 
   AzObjPtrArray<AzSortedFeat_Dense> a_dense; 
   int f_num; 
@@ -243,25 +271,53 @@ protected:
   AzIntArr ia_isActive; 
   int active_num; 
 
+  /*---  not beTight: the sorted indexes of all the dense features are      ---*/
+  /*---  in one buffer of the base, which is stably partitioned in place    ---*/
+  /*---  when a node is split.  A node looks at [part_offset,              ---*/
+  /*---  part_offset+part_num) of each feature, i.e., dxs_offset of node.  ---*/
+  /*---  Sparse features are separated into new ones as before.           ---*/
+  const AzSortedFeatArr *part_base; /* NULL if not partitioned */
+  const AzSortedFeatArr *part_org;  /* the original, which has the values */
+  int part_offset, part_num; 
+  AzIntArr ia_part;      /* base only: [ia_fx2part[fx]*part_stride+ix] */
+  AzIntArr ia_part_grp;  /* base only: distinct value# of ia_part's */
+  AzIntArr ia_fx2part;   /* base only: -1 for sparse features */
+  int part_fnum;         /* base only: #dense features */
+  int part_stride;       /* base only: #data at the root */
+  AzIntArr ia_part_work; /* base only: for separation */
+
 public: 
-  AzSortedFeatArr() : arrs(NULL), arrd(NULL), f_num(0), beTight(false) {}
+  AzSortedFeatArr() : arrs(NULL), arrd(NULL), f_num(0), beTight(false), 
+                      active_num(0), part_base(NULL), part_org(NULL), 
+                      part_offset(0), part_num(0), part_fnum(0), part_stride(0) {}
   AzSortedFeatArr(const AzSortedFeatArr *inp)
-                    : arrs(NULL), arrd(NULL), f_num(0), beTight(false) {
+                    : arrs(NULL), arrd(NULL), f_num(0), beTight(false), 
+                      active_num(0), part_base(NULL), part_org(NULL), 
+                      part_offset(0), part_num(0), part_fnum(0), part_stride(0) {
     copy_base(inp); 
   }
   AzSortedFeatArr(const AzSortedFeatArr *inp, const int *dxs, int dxs_num) 
-                    : arrs(NULL), arrd(NULL), f_num(0), beTight(false) {
+                    : arrs(NULL), arrd(NULL), f_num(0), beTight(false), 
+                      active_num(0), part_base(NULL), part_org(NULL), 
+                      part_offset(0), part_num(0), part_fnum(0), part_stride(0) {
     filter_base(inp, dxs, dxs_num); 
   }
-  void reset_sparse(const AzSmat *m_tran, 
-                    bool beTight=false); 
-  void reset_dense(const AzDmat *m_tran_dense, 
-                   bool inp_beTight=false); 
-
-  inline bool doingSparse() const {
-    if (arrs != NULL) return true; 
-    else              return false; 
-  }
+
+  /*---  feature fx is dense if ia_fx2dense[fx] >= 0, and its values are  ---*/
+  /*---  m_tran_dense's column ia_fx2dense[fx]; otherwise m_tran's fx.    ---*/
+  void reset(const AzSmat *m_tran,        /* NULL if no sparse feature */
+             const AzDmat *m_tran_dense,  /* NULL if no dense feature */
+             const AzIntArr *ia_fx2dense, 
+             bool inp_beTight=false); 
+
+  /*---  save/restore what reset made  ---*/
+  void write(AzFile *file); 
+  void read(AzFile *file, 
+            const AzSmat *m_tran,  
+            const AzDmat *m_tran_dense, 
+            const AzIntArr *ia_fx2dense, 
+            bool inp_beTight=false); 
+
   inline int featNum() const {
     return f_num; 
   }
@@ -269,14 +325,18 @@ public:
     if (fx < 0 || fx >= f_num) {
       throw new AzException("AzSortedFeatArr::sorted", "out of range"); 
     }
+    if (arrs != NULL && arrs[fx] != NULL) {
+      return arrs[fx]; 
+    }
+    if (part_base != NULL) {
+      return NULL; 
+    }
     if (arrd != NULL) {
       return arrd[fx]; 
     }
-    if (arrs != NULL) {
-      return arrs[fx]; 
-    }
     return NULL; 
   }
+  /*---  called when sorted(fx) returns NULL (beTight or partitioned)  ---*/
   const AzSortedFeat *sorted(const AzSortedFeatArr *inp, 
               int fx, 
               AzSortedFeatWork *out) const; 
@@ -287,6 +347,12 @@ public:
     f_num = 0; 
     ia_isActive.reset(); 
     active_num = 0;   
+    reset_part(); 
+    ia_part.reset(); 
+    ia_part_grp.reset(); 
+    ia_fx2part.reset(); 
+    part_fnum = 0; 
+    ia_part_work.reset(); 
   }
 
   static void separate(AzSortedFeatArr *base, 
@@ -301,7 +367,18 @@ public:
 protected:
   static void sub_initialize(const AzSortedFeatArr *inp, 
                       AzSortedFeatArr *ptr); 
+  void alloc_arr(bool doSparse, bool doDense); 
+  static int check_input(const AzSmat *m_tran, const AzDmat *m_tran_dense, 
+                         const AzIntArr *ia_fx2dense, 
+                         int *out_dense_num); /* returns #data */
+  void make_part(const AzSortedFeatArr *inp, const AzIntArr *ia_isYes, int num); 
+  void separate_part(const AzSortedFeatArr *inp, 
+                     const AzIntArr *ia_isYes, int yes_num, 
+                     AzSortedFeatArr *yes, AzSortedFeatArr *no); 
+  inline void reset_part() { /* keep the buffers for reuse */
+    part_base = part_org = NULL; 
+    part_offset = part_num = part_stride = 0; 
+  }
 }; 
 
-#endif 
-
+#endif
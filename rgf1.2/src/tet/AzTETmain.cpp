@@ -24,6 +24,8 @@
 #include "AzTaskTools.hpp"
 #include "AzHelp.hpp"
 #include "AzTETproc.hpp"
+#include "AzTreeEnsemble_Flat.hpp"
+#include "AzTETserve.hpp"
 
 static int exe_argx = 0; 
 static int action_argx = 1; 
@@ -89,6 +91,7 @@ void AzTETmain::readData(const char *x_fn,
 const 
 {
   AzSvDataS dataset; 
+  dataset.set_thread_num(read_thread_num); 
   dataset.read(x_fn, y_fn, fdic_fn); 
   m_x->set(dataset.feat()); 
   v_y->set(dataset.targets()); 
@@ -143,9 +146,28 @@ void AzTETmain::predict_single(const char *argv[], int argc)
   print_hline(log_out); 
   checkParam_predict_single();
 
+  if (pred_block_size > 0) {
+    /*---  read test data a block at a time  ---*/
+    AzDvect v_y; 
+    if (s_test_y_fn.length() > 0) {
+      AzSvDataS::readVector(s_test_y_fn.c_str(), &v_y); 
+      eval->reset(&v_y, s_eval_fn.c_str(), doAppend_eval); 
+      eval->begin(); 
+    }
+    AzTimeLog::print("Predicting ... ", log_out); 
+    _predict_stream(s_test_x_fn.c_str(), s_model_fn.c_str(), s_pred_fn.c_str(), log_out, 
+                    (s_test_y_fn.length() > 0) ? &v_y : NULL); 
+    if (s_test_y_fn.length() > 0) {
+      eval->end(); 
+    }
+    AzTimeLog::print("Done ... ", log_out); 
+    return; 
+  }
+
   /*---  read test data  ---*/
   AzTimeLog::print("Reading test data ... ", log_out); 
   AzSvDataS dataset; 
+  dataset.set_thread_num(read_thread_num); 
   bool doEval = false;
   if (s_test_y_fn.length() > 0) {
     dataset.read(s_test_x_fn.c_str(), s_test_y_fn.c_str());     
@@ -171,16 +193,8 @@ void AzTETmain::predict_single(const char *argv[], int argc)
 void AzTETmain::writePrediction_single(const AzDvect *v_p, 
                                        AzFile *file)
 {
-  /* one prediction value per line */
-  int width = 8; 
-  AzBytArr s; 
-  int dx; 
-  for (dx = 0; dx < v_p->rowNum(); ++dx) {
-    double val = v_p->get(dx); 
-    s.concatFloat(val, width); 
-    s.nl(); /* new line */
-  } 
-  s.writeText(file); 
+  /* one prediction value per line, written a block at a time */
+  AzTETproc::writePrediction(v_p, file); 
 }
 
 /*------------------------------------------------*/
@@ -190,35 +204,112 @@ void AzTETmain::_predict(const AzSvDataS *dataset,
                          const AzOut &out, 
                          bool doEval) const
 {
-  AzTreeEnsemble ens(model_fn); 
-  if (ens.orgdim() > 0 && 
-      ens.orgdim() != dataset->featNum()) {
+  AzTreeEnsemble_Flat flat; 
+  flat.reset(model_fn); /* either format */
+  if (flat.orgdim() > 0 && 
+      flat.orgdim() != dataset->featNum()) {
     AzBytArr s("#feature in test data is "); s.cn(dataset->featNum()); 
-    s.c(", whereas #feature in training data was "); s.cn(ens.orgdim()); 
+    s.c(", whereas #feature in training data was "); s.cn(flat.orgdim()); 
     throw new AzException(AzInputError, "AzTETmain::_predict", s.c_str()); 
   }
+  AzTE_ModelInfo info; 
+  flat.info(&info); 
   AzDvect v_test_p; 
   clock_t t0 = clock(); 
-  ens.apply(dataset->feat(), &v_test_p); 
+  flat.apply(dataset->feat(), &v_test_p); 
   clock_t apply_clk = clock() - t0; 
 
+  if (!out.isNull()) {
+    show_elapsed(out, apply_clk); 
+  }
+  _write_prediction(&v_test_p, model_fn, &info, pred_fn, out, doEval); 
+}
+
+/*------------------------------------------------*/
+void AzTETmain::_write_prediction(const AzDvect *v_test_p, 
+                         const char *model_fn, 
+                         const AzTE_ModelInfo *info, 
+                         const char *pred_fn, 
+                         const AzOut &out, 
+                         bool doEval) const
+{
   /*---  write predictions  ---*/
   AzFile pred_file(pred_fn);  
   pred_file.open("wb"); 
-  writePrediction_single(&v_test_p, &pred_file); 
+  writePrediction_single(v_test_p, &pred_file); 
   pred_file.close(true); 
 
   if (!out.isNull()) {
-    show_elapsed(out, apply_clk); 
     AzBytArr s(pred_fn); s.c(": "); 
     AzBytArr s_info; 
-    format_info(model_fn, &ens, "=", ",", &s_info); 
+    format_info(model_fn, info, "=", ",", &s_info); 
     AzPrint::writeln(out, s, s_info); 
   }
   if (doEval) {
     /*---  write evaluation if required  ---*/
-    AzTE_ModelInfo info; 
-    ens.info(&info); 
+    eval->evaluate(v_test_p, info, model_fn); 
+  }
+}
+
+/*------------------------------------------------*/
+void AzTETmain::_predict_stream(const char *x_fn, 
+                         const char *model_fn, 
+                         const char *pred_fn, 
+                         const AzOut &out, 
+                         const AzDvect *v_y) const
+{
+  const char *eyec = "AzTETmain::_predict_stream"; 
+  AzTreeEnsemble_Flat flat; 
+  flat.reset(model_fn); /* once for all the blocks */
+  AzTE_ModelInfo info; 
+  flat.info(&info); 
+  AzSvDataS_Stream stream; 
+  stream.open(x_fn, -1, read_thread_num); 
+  if (flat.orgdim() > 0 && 
+      flat.orgdim() != stream.featNum()) {
+    AzBytArr s("#feature in test data is "); s.cn(stream.featNum()); 
+    s.c(", whereas #feature in training data was "); s.cn(flat.orgdim()); 
+    throw new AzException(AzInputError, eyec, s.c_str()); 
+  }
+
+  AzDvect v_test_p; /* kept only for evaluation */
+  if (v_y != NULL) v_test_p.reform(v_y->rowNum()); 
+
+  AzFile pred_file(pred_fn);  
+  pred_file.open("wb"); 
+  AzSmat m_x; 
+  AzDvect v_p; 
+  clock_t apply_clk = 0; 
+  for ( ; ; ) {
+    int offs = stream.dataNum_done(); 
+    int num = stream.read(pred_block_size, &m_x); 
+    if (num <= 0) break; 
+    clock_t t0 = clock(); 
+    flat.apply(&m_x, &v_p); 
+    apply_clk += clock() - t0; 
+    writePrediction_single(&v_p, &pred_file); 
+    if (v_y != NULL) {
+      if (offs + num > v_test_p.rowNum()) {
+        throw new AzException(AzInputNotValid, eyec, "More data points in the feature file than the target file"); 
+      }
+      memcpy(v_test_p.point_u()+offs, v_p.point(), sizeof(double)*num); 
+    }
+  }
+  pred_file.close(true); 
+  stream.close(); 
+  if (v_y != NULL && stream.dataNum_done() != v_test_p.rowNum()) {
+    throw new AzException(AzInputNotValid, eyec, "Fewer data points in the feature file than the target file"); 
+  }
+
+  if (!out.isNull()) {
+    show_elapsed(out, apply_clk); 
+    AzBytArr s(pred_fn); s.c(": "); 
+    AzBytArr s_info; 
+    format_info(model_fn, &info, "=", ",", &s_info); 
+    AzPrint::writeln(out, s, s_info); 
+  }
+  if (v_y != NULL) {
+    /*---  write evaluation if required  ---*/
     eval->evaluate(&v_test_p, &info, model_fn); 
   }
 }
@@ -238,6 +329,7 @@ void AzTETmain::batch_predict(const char *argv[], int argc)
   /*---  read test data  ---*/
   bool doEval = false;
   AzSvDataS dataset; 
+  dataset.set_thread_num(read_thread_num); 
   if (s_test_y_fn.length() > 0) {
     dataset.read(s_test_x_fn.c_str(), s_test_y_fn.c_str(), s_fdic_fn.c_str());     
     doEval = true; 
@@ -254,13 +346,40 @@ void AzTETmain::batch_predict(const char *argv[], int argc)
   AzStrPool sp_model_fn; 
   AzTools::readList(s_model_names_fn.c_str(), 
                     &sp_model_fn); 
-  int num = sp_model_fn.size(); 
+
+  /*---  all the models in one pass; shared trees are traversed once  ---*/
+  AzTreeEnsemble_FlatBatch batch; 
+  batch.reset(&sp_model_fn); 
+  int num = batch.modelNum(); 
   int ix; 
+  for (ix = 0; ix < num; ++ix) {
+    int orgdim = batch.model(ix)->orgdim(); 
+    if (orgdim > 0 && orgdim != dataset.featNum()) {
+      AzBytArr s("#feature in test data is "); s.cn(dataset.featNum()); 
+      s.c(", whereas #feature in training data was "); s.cn(orgdim); 
+      s.c(" for "); s.c(sp_model_fn.c_str(ix)); 
+      throw new AzException(AzInputError, "AzTETmain::batch_predict", s.c_str()); 
+    }
+  }
+  if (!log_out.isNull()) {
+    AzBytArr s("#model="); s.cn(num); 
+    s.c(", #tree="); s.cn(batch.treeNum()); 
+    s.c(", #distinct tree="); s.cn(batch.structNum()); 
+    AzPrint::writeln(log_out, s); 
+  }
+  AzDataArray<AzDvect> av_test_p; 
+  clock_t t0 = clock(); 
+  batch.apply(dataset.feat(), &av_test_p); 
+  if (!log_out.isNull()) {
+    show_elapsed(log_out, clock() - t0); 
+  }
   for (ix = 0; ix < num; ++ix) {
     const char *model_fn = sp_model_fn.c_str(ix); 
     AzBytArr s_pred_fn(model_fn); 
     s_pred_fn.concat(&s_pred_fn_suffix); 
-    _predict(&dataset, model_fn, s_pred_fn.c_str(), log_out, doEval); 
+    AzTE_ModelInfo info; 
+    batch.model(ix)->info(&info); 
+    _write_prediction(av_test_p.point(ix), model_fn, &info, s_pred_fn.c_str(), log_out, doEval); 
   }
   if (doEval) {
     eval->end(); 
@@ -391,16 +510,14 @@ void AzTETmain::show_elapsed(const AzOut &out,
 
 /*------------------------------------------------------------------*/
 void AzTETmain::format_info(const char *model_fn, 
-                          const AzTreeEnsemble *ens, 
+                          const AzTE_ModelInfo *info, 
                           const char *name_dlm, 
                           const char *dlm, 
                           AzBytArr *s) const 
 {
-  AzTE_ModelInfo info; 
-  ens->info(&info);
   s->c(model_fn); s->c(dlm); 
-  s->c("#leaf"); s->c(name_dlm); s->cn(info.leaf_num); s->c(dlm); 
-  s->c("#tree"); s->c(name_dlm); s->cn(info.tree_num);
+  s->c("#leaf"); s->c(name_dlm); s->cn(info->leaf_num); s->c(dlm); 
+  s->c("#tree"); s->c(name_dlm); s->cn(info->tree_num);
 }
 
 /*------------------------------------------------*/
@@ -440,6 +557,7 @@ void AzTETmain::train_predict(const char *argv[], int argc,
   /*---  read test data  ---*/
   AzSmat m_test_x; 
   AzSvDataS dataset; 
+  dataset.set_thread_num(read_thread_num); 
   dataset.read_features_only(s_test_x_fn.c_str()); 
   m_test_x.set(dataset.feat()); 
   dataset.destroy(); 
@@ -522,6 +640,7 @@ bool AzTETmain::resetParam_train(const char *argv[], int argc,
   /*---  separate unused parameters to pass to TreeEnsembleTrainer  ---*/
   s_tet_param.reset(); 
   p.check(log_out, &s_tet_param); 
+  peek_read_thread_num(param); 
 
   return true; /* success */
 }
@@ -614,6 +733,7 @@ bool AzTETmain::resetParam_train_predict(const char *argv[], int argc)
   /*---  separate unused parameters to pass to TreeEnsembleTrainer  ---*/
   s_tet_param.reset(); 
   p.check(log_out, &s_tet_param); 
+  peek_read_thread_num(param); 
 
   return true; /* success */
 }
@@ -678,6 +798,8 @@ const
   else if (s_action.compare(kw_train_test) == 0)    s_desc.c(help_train_test); 
   else if (s_action.compare(kw_predict) == 0)       s_desc.c(help_predict); 
   else if (s_action.compare(kw_batch_predict) == 0) s_desc.c(help_batch_predict); 
+  else if (s_action.compare(kw_convert) == 0)       s_desc.c(help_convert); 
+  else if (s_action.compare(kw_serve) == 0)         s_desc.c(help_serve); 
   if (s_desc.length() > 0) {
     h.item(s_kw.c_str(), s_desc.c_str()); 
   }
@@ -700,6 +822,12 @@ const
     }
     s.c("..."); 
   }
+  else if (s_action.compare(kw_convert) == 0) {
+    s.c("input_x_fn=data.x,output_x_fn=data.xbin"); 
+  }
+  else if (s_action.compare(kw_serve) == 0) {
+    s.c("model_fn=model.bin-01,socket_fn=/tmp/rgf.sock"); 
+  }
   else {
     s.c("model_fn=model.bin-01,test_x_fn=test-data.x,..."); 
   }
@@ -848,6 +976,7 @@ bool AzTETmain::resetParam_batch_predict(const char *argv[], int argc)
   p.vStr(kw_test_y_fn, &s_test_y_fn); 
   p.vStr(kw_eval_fn, &s_eval_fn); 
   p.swOn(&doAppend_eval, kw_doAppend_eval); 
+  p.vInt(kw_read_thread_num, &read_thread_num); 
 
   p.swOff(&doLog, kw_not_doLog); 
   p.swOn(&doDump, kw_doDump); 
@@ -871,6 +1000,7 @@ void AzTETmain::printParam_batch_predict(const AzOut &out) const
   o.printV_if_not_empty(kw_test_y_fn, s_test_y_fn);
   o.printV_if_not_empty(kw_eval_fn, s_eval_fn); 
   o.printSw(kw_doAppend_eval, doAppend_eval); 
+  o.printV(kw_read_thread_num, read_thread_num); 
 
   o.printSw(kw_doLog, doLog); 
   o.printSw(kw_doDump, doDump); 
@@ -897,6 +1027,7 @@ void AzTETmain::printHelp_batch_predict(const AzOut &out,
   h.item(kw_test_y_fn, help_test_y_fn); 
   h.item(kw_eval_fn, help_eval_fn, "stdout"); 
   h.item_experimental(kw_doAppend_eval, help_doAppend_eval); 
+  h.item_experimental(kw_read_thread_num, help_read_thread_num, 1); 
   h.item_experimental(kw_not_doLog, help_not_doLog); 
   h.item_experimental(kw_doDump, help_doDump); 
 
@@ -940,10 +1071,12 @@ bool AzTETmain::resetParam_predict_single(const char *argv[], int argc)
   p.vStr(kw_model_fn, &s_model_fn); 
   p.vStr(kw_test_x_fn, &s_test_x_fn); 
   p.vStr(kw_pred_fn, &s_pred_fn); 
+  p.vInt(kw_pred_block_size, &pred_block_size); 
 
   p.vStr(kw_test_y_fn, &s_test_y_fn); 
   p.vStr(kw_eval_fn, &s_eval_fn); 
   p.swOn(&doAppend_eval, kw_doAppend_eval); 
+  p.vInt(kw_read_thread_num, &read_thread_num); 
 
   p.swOff(&doLog, kw_not_doLog); 
   p.swOn(&doDump, kw_doDump); 
@@ -962,10 +1095,12 @@ void AzTETmain::printParam_predict_single(const AzOut &out) const
   o.printV(kw_model_fn, s_model_fn); 
   o.printV(kw_test_x_fn, s_test_x_fn); 
   o.printV(kw_pred_fn, s_pred_fn);  
+  o.printV(kw_pred_block_size, pred_block_size); 
 
   o.printV_if_not_empty(kw_test_y_fn, s_test_y_fn);
   o.printV_if_not_empty(kw_eval_fn, s_eval_fn); 
   o.printSw(kw_doAppend_eval, doAppend_eval); 
+  o.printV(kw_read_thread_num, read_thread_num); 
 
   o.printSw(kw_doLog, doLog); 
   o.printSw(kw_doDump, doDump); 
@@ -984,6 +1119,7 @@ void AzTETmain::printHelp_predict_single(const AzOut &out,
   h.item_required(kw_model_fn, help_model_fn); 
   h.item_required(kw_test_x_fn, help_test_x_fn); 
   h.item_required(kw_pred_fn, help_pred_fn_out); 
+  h.item(kw_pred_block_size, help_pred_block_size, 0); 
 
   h.nl(); 
   h.writeln_header_experimental("To optionally evaluate the prediction values: "); 
@@ -991,6 +1127,7 @@ void AzTETmain::printHelp_predict_single(const AzOut &out,
   h.item_experimental(kw_eval_fn, help_eval_fn, "stdout"); 
 
   h.item_experimental(kw_doAppend_eval, help_doAppend_eval); 
+  h.item_experimental(kw_read_thread_num, help_read_thread_num, 1); 
   h.item_experimental(kw_not_doLog, help_not_doLog); 
   h.item_experimental(kw_doDump, help_doDump); 
 
@@ -1049,6 +1186,7 @@ bool AzTETmain::resetParam_xv(const char *argv[], int argc)
   /*---  separate unused parameters to pass to TreeEnsembleTrainer  ---*/
   s_tet_param.reset(); 
   p.check(log_out, &s_tet_param); 
+  peek_read_thread_num(param); 
 
   return true; /* success */
 }
@@ -1186,3 +1324,218 @@ void AzTETmain::printHelp_features(const AzOut &out,
   h.item(kw_doSparse_features, help_doSparse_features); 
   h.end(); 
 }
+
+/*------------------------------------------------------*/
+/*------------------------------------------------------*/
+/*  convert a data file to the binary format            */
+/*------------------------------------------------------*/
+void AzTETmain::convert(const char *argv[], int argc)
+{
+  bool success = resetParam_convert(argv, argc); 
+  if (!success) return; 
+
+  prepareLogDmp(doLog, doDump);
+
+  printParam_convert(log_out); 
+  print_hline(log_out); 
+  checkParam_convert();
+
+  if (s_input_x_fn.length() > 0) {
+    AzSvDataS dataset; 
+    dataset.set_thread_num(read_thread_num); 
+    dataset.read_features_only(s_input_x_fn.c_str()); 
+    AzTimeLog::print("Writing ", s_output_x_fn.c_str(), log_out); 
+    AzSvDataS::writeData_Binary(s_output_x_fn.c_str(), dataset.feat()); 
+  }
+  if (s_model_fn.length() > 0) {
+    AzTreeEnsemble_Flat flat; 
+    flat.reset(s_model_fn.c_str()); 
+    AzTimeLog::print("Writing ", s_output_model_fn.c_str(), log_out); 
+    flat.write(s_output_model_fn.c_str()); 
+  }
+  AzTimeLog::print("Done ... ", log_out); 
+}
+
+/*------------------------------------------------*/
+/*------------------------------------------------*/
+bool AzTETmain::resetParam_convert(const char *argv[], int argc)
+{
+  if (argc-config_argx != 1) {
+    printHelp_convert(log_out, argv, argc); 
+    return false; /* faied */
+  }
+
+  const char *param = argv[config_argx]; 
+  if (isHelpNeeded(param)) {
+    printHelp_convert(log_out, argv, argc); 
+    return false; /* failed */    
+  }
+
+  AzParam p(param); 
+  p.vStr(kw_input_x_fn, &s_input_x_fn); 
+  p.vStr(kw_output_x_fn, &s_output_x_fn); 
+  p.vStr(kw_model_fn, &s_model_fn); 
+  p.vStr(kw_output_model_fn, &s_output_model_fn); 
+  p.vInt(kw_read_thread_num, &read_thread_num); 
+  p.check(log_out); 
+
+  return true; 
+}
+
+/*------------------------------------------------*/
+void AzTETmain::printParam_convert(const AzOut &out) const
+{
+  if (out.isNull()) return; 
+  AzPrint o(out); 
+  o.ppBegin("AzTETmain::convert", "\"convert\""); 
+  o.printV_if_not_empty(kw_input_x_fn, s_input_x_fn); 
+  o.printV_if_not_empty(kw_output_x_fn, s_output_x_fn); 
+  o.printV_if_not_empty(kw_model_fn, s_model_fn); 
+  o.printV_if_not_empty(kw_output_model_fn, s_output_model_fn); 
+  o.printV(kw_read_thread_num, read_thread_num); 
+  o.ppEnd(); 
+}
+
+/*------------------------------------------------*/
+void AzTETmain::checkParam_convert() const
+{
+  const char *eyec = "AzTETmain::checkParam_convert"; 
+  if (s_input_x_fn.length() <= 0 && s_model_fn.length() <= 0) {
+    throw_if_missing(kw_input_x_fn, s_input_x_fn, eyec); 
+  }
+  if (s_input_x_fn.length() > 0) {
+    throw_if_missing(kw_output_x_fn, s_output_x_fn, eyec); 
+    if (s_input_x_fn.compare(&s_output_x_fn) == 0) {
+      throw new AzException(AzInputError, eyec, "The input and output must be different files"); 
+    }
+  }
+  if (s_model_fn.length() > 0) {
+    throw_if_missing(kw_output_model_fn, s_output_model_fn, eyec); 
+    if (s_model_fn.compare(&s_output_model_fn) == 0) {
+      throw new AzException(AzInputError, eyec, "The input and output must be different files"); 
+    }
+  }
+}
+
+/*------------------------------------------------*/
+void AzTETmain::printHelp_convert(const AzOut &out, 
+                const char *argv[], int argc) const
+{
+  print_usage(out, argv, argc); 
+  AzHelp h(out);
+  h.begin("convert", "AzTETmain"); 
+  h.item(kw_input_x_fn, help_convert_input_fn); 
+  h.item(kw_output_x_fn, help_convert_output_fn); 
+  h.item(kw_model_fn, help_convert_model_fn); 
+  h.item(kw_output_model_fn, help_convert_output_model_fn); 
+  h.item(kw_read_thread_num, help_read_thread_num, 1); 
+  h.end(); 
+}
+
+/*------------------------------------------------------*/
+/*------------------------------------------------------*/
+/*  keep models loaded and answer prediction requests   */
+/*------------------------------------------------------*/
+void AzTETmain::serve(const char *argv[], int argc)
+{
+  bool success = resetParam_serve(argv, argc); 
+  if (!success) return; 
+
+  prepareLogDmp(doLog, doDump);
+  if (s_socket_fn.length() <= 0 && doLog) {
+    log_out.setStderr(); /* stdout is for the responses */
+  }
+
+  printParam_serve(log_out); 
+  print_hline(log_out); 
+  checkParam_serve();
+
+  AzStrPool sp_model_fn; 
+  if (s_model_fn.length() > 0) {
+    sp_model_fn.put(&s_model_fn); 
+  }
+  if (s_model_names_fn.length() > 0) {
+    AzStrPool sp; 
+    AzTools::readList(s_model_names_fn.c_str(), &sp); 
+    sp_model_fn.put(&sp); 
+  }
+  AzTETserve server; 
+  server.reset(&sp_model_fn, read_thread_num, log_out); 
+  if (s_socket_fn.length() > 0) {
+    server.serve_socket(s_socket_fn.c_str(), log_out); 
+  }
+  else {
+    server.serve_stdio(log_out); 
+  }
+}
+
+/*------------------------------------------------*/
+/*------------------------------------------------*/
+bool AzTETmain::resetParam_serve(const char *argv[], int argc)
+{
+  if (argc-config_argx != 1) {
+    printHelp_serve(log_out, argv, argc); 
+    return false; /* failed */
+  }
+
+  const char *param = argv[config_argx]; 
+  if (isHelpNeeded(param)) {
+    printHelp_serve(log_out, argv, argc); 
+    return false; /* failed */    
+  }
+
+  AzParam p(param); 
+  p.vStr(kw_model_fn, &s_model_fn); 
+  p.vStr(kw_model_names_fn, &s_model_names_fn); 
+  p.vStr(kw_socket_fn, &s_socket_fn); 
+  p.vInt(kw_read_thread_num, &read_thread_num); 
+  p.swOff(&doLog, kw_not_doLog); 
+  p.check(log_out); 
+
+  return true; 
+}
+
+/*------------------------------------------------*/
+void AzTETmain::printParam_serve(const AzOut &out) const
+{
+  if (out.isNull()) return; 
+  AzPrint o(out); 
+  o.ppBegin("AzTETmain::serve", "\"serve\""); 
+  o.printV_if_not_empty(kw_model_fn, s_model_fn); 
+  o.printV_if_not_empty(kw_model_names_fn, s_model_names_fn); 
+  o.printV_if_not_empty(kw_socket_fn, s_socket_fn); 
+  o.printV(kw_read_thread_num, read_thread_num); 
+  o.printSw(kw_doLog, doLog); 
+  o.ppEnd(); 
+}
+
+/*------------------------------------------------*/
+void AzTETmain::checkParam_serve() const
+{
+  const char *eyec = "AzTETmain::checkParam_serve"; 
+  if (s_model_names_fn.length() <= 0) {
+    throw_if_missing(kw_model_fn, s_model_fn, eyec); 
+  }
+}
+
+/*------------------------------------------------*/
+void AzTETmain::printHelp_serve(const AzOut &out, 
+                const char *argv[], int argc) const
+{
+  print_usage(out, argv, argc); 
+  AzHelp h(out);
+  h.begin("serve", "AzTETmain"); 
+  h.item(kw_model_fn, help_serve_model_fn); 
+  h.item(kw_model_names_fn, help_serve_model_names_fn); 
+  h.item(kw_socket_fn, help_socket_fn); 
+  h.item(kw_read_thread_num, help_read_thread_num, 1); 
+  h.item(kw_not_doLog, help_not_doLog); 
+  h.nl(); 
+  h.writeln_header("Requests (one per line): "); 
+  h.writeln_header("  file <path>       : predict on a data file"); 
+  h.writeln_header("  rows <n> [sparse] : predict on the n lines that follow, in the data file format"); 
+  h.writeln_header("  models            : list the models"); 
+  h.writeln_header("  quit | shutdown   : end the client | end the server"); 
+  h.writeln_header("Responses: \"ok <n> <m>\" followed by n lines of m predictions, or \"error <message>\""); 
+  h.end(); 
+}
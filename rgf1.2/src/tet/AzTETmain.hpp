@@ -52,15 +52,20 @@ protected:
   int xv_num; 
 
   AzBytArr s_input_x_fn, s_output_x_fn; 
+  AzBytArr s_output_model_fn; 
+  AzBytArr s_socket_fn; 
   bool doSparse_features; 
   int features_digits; 
+  int read_thread_num; 
+  int pred_block_size; 
 public:
   AzTETmain(const AzTETselector *inp_alg_sel, 
             AzTET_Eval *inp_eval) : s_model_stem(dflt_model_stem), eval(NULL), 
                                     doLog(true), doDump(false), doAppend_eval(false), 
                                     doSaveLastModelOnly(false), 
                                     xv_doShuffle(false), xv_num(2), 
-                                    doSparse_features(false), features_digits(10)
+                                    doSparse_features(false), features_digits(10), 
+                                    read_thread_num(1), pred_block_size(0)
   {
     alg_sel = inp_alg_sel; 
     eval = inp_eval; 
@@ -75,6 +80,8 @@ public:
   virtual void xv(const char *argv[], int argc); 
 
   virtual void features(const char *argv[], int argc); 
+  virtual void convert(const char *argv[], int argc); 
+  virtual void serve(const char *argv[], int argc); 
 
   virtual void printHelp_train(const AzOut &out, 
                                const char *argv[], int argc, 
@@ -139,8 +146,25 @@ protected:
   virtual void printHelp_features(const AzOut &out, 
                 const char *argv[], int argc) const; 
 
+  virtual bool resetParam_convert(const char *argv[], int argc); 
+  virtual void printParam_convert(const AzOut &out) const; 
+  virtual void checkParam_convert() const; 
+  virtual void printHelp_convert(const AzOut &out, 
+                const char *argv[], int argc) const; 
+  virtual bool resetParam_serve(const char *argv[], int argc); 
+  virtual void printParam_serve(const AzOut &out) const; 
+  virtual void checkParam_serve() const; 
+  virtual void printHelp_serve(const AzOut &out, 
+                const char *argv[], int argc) const; 
+
   virtual bool isHelpNeeded(const char *param) const; 
 
+  /*---  data reading uses the trainer's num_threads without taking it  ---*/
+  virtual void peek_read_thread_num(const char *param) {
+    AzParam p(param, false); 
+    p.vInt(kw_read_thread_num, &read_thread_num); 
+  }
+
   inline virtual void throw_if_missing(const char *kw, const AzBytArr &s_val, 
                                   const char *eyec) const {
     if (s_val.length() <= 0) {
@@ -156,7 +180,7 @@ protected:
     return true; 
   }
   virtual void format_info(const char *model_fn, 
-                          const AzTreeEnsemble *ens, 
+                          const AzTE_ModelInfo *info, 
                           const char *name_dlm, 
                           const char *dlm, 
                           AzBytArr *s_info) const; 
@@ -165,6 +189,17 @@ protected:
                          const char *pred_fn, 
                          const AzOut &out, 
                          bool doEval) const; 
+  virtual void _write_prediction(const AzDvect *v_test_p, 
+                         const char *model_fn, 
+                         const AzTE_ModelInfo *info, 
+                         const char *pred_fn, 
+                         const AzOut &out, 
+                         bool doEval) const; 
+  virtual void _predict_stream(const char *x_fn, 
+                         const char *model_fn, 
+                         const char *pred_fn, 
+                         const AzOut &out, 
+                         const AzDvect *v_y) const; /* NULL if no evaluation */
 
   virtual void print_config(const AzBytArr &s_config, 
                             const AzOut &out) const; 
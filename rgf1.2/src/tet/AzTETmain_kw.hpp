@@ -25,12 +25,16 @@
 #define kw_batch_predict "batch_predict"
 #define kw_train_predict "train_predict"
 #define kw_features      "output_features"
+#define kw_convert       "convert"
+#define kw_serve         "serve"
 #define help_train         "Train and save models to files."
 #define help_train_test    "Train and test models.  Optionally models can be saved to files."
 #define help_train_predict "Train models and save predictions on test data to files.  Models can also be saved to files."  
 #define help_predict       "Apply a model saved by \"train\" to new data."
-#define help_batch_predict "Apply several models to new data."
+#define help_batch_predict "Apply several models to new data in one pass; trees shared by the models are traversed once."
 #define help_features      "Output features generated by tree ensembles."
+#define help_convert       "Convert a data file or a model file to the binary format, which is read faster."
+#define help_serve         "Load models once and answer prediction requests from stdin or a Unix domain socket."
 
 #define kw_alg_name "algorithm="
 #define kw_train_x_fn "train_x_fn="
@@ -57,8 +61,12 @@
 #define kw_xv_fn "xv_fn="
 #define kw_input_x_fn "input_x_fn="
 #define kw_output_x_fn "output_x_fn="
+#define kw_output_model_fn "output_model_fn="
 #define kw_features_digits "features_digits="
+#define kw_read_thread_num "num_threads="  /* shared with the trainer for training */
+#define kw_pred_block_size "prediction_block_size="
 #define kw_doSparse_features "SparseFeatures"
+#define kw_socket_fn "socket_fn="
 
 #define help_train_x_fn "Path to the feature file of training data."
 #define help_train_y_fn "Path to the target file of training data."
@@ -85,6 +93,15 @@
 
 #define help_input_x_fn "Path to the input feature file."
 #define help_output_x_fn "Path to the output feature file."
+#define help_read_thread_num "Number of threads for reading data files.  0: as many as the cores."
+#define help_pred_block_size "If positive, test data is read, scored, and written to the prediction file this many data points at a time, so that memory usage does not grow with the size of test data.  0: all at once."
+#define help_convert_input_fn "Path to the input data file (features, targets, or weights)."
+#define help_convert_output_fn "Path to the binary data file to be written.  It can be used in place of the input file as train_x_fn, test_x_fn, etc."
+#define help_convert_model_fn "Path to the model file (saved by \"train\") to be converted."
+#define help_convert_output_model_fn "Path to the flat model file to be written.  It can be used in place of the input model by \"predict\" and \"batch_predict\", and it is memory-mapped and used as it is, so it loads fast."
+#define help_serve_model_fn "Path to the model file to be loaded."
+#define help_serve_model_names_fn "Path to the file to read the paths of more models to be loaded from.  Predictions are returned one column per model, model_fn= first."
+#define help_socket_fn "Path to the Unix domain socket to listen on.  If omitted, requests are read from stdin and responses are written to stdout, and log goes to stderr."
 #define help_features_digits "How many digits should be retained in the output."
 #define help_doSparse_features "Write features in the sparse data format."
 
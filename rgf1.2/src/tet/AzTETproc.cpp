@@ -69,7 +69,7 @@ void AzTETproc::train_test(const AzOut &out,
                         /*---  for warm start  ---*/
                         AzTreeEnsemble *inp_ens) /* may be NULL */
 {
-  AzTETrainer_TestData td(out, m_test_x); 
+  AzTETrainer_TestData td(out, m_test_x, thread_num(config)); 
 
   trainer->startup(out, config, m_train_x, v_train_y, featInfo, v_fixed_dw, inp_ens); 
   eval->begin(config, trainer->lossType()); 
@@ -110,7 +110,7 @@ void AzTETproc::train_test_save(const AzOut &out,
                         /*---  for warm start  ---*/
                         AzTreeEnsemble *inp_ens) /* may be NULL */
 {
-  AzTETrainer_TestData td(out, m_test_x); 
+  AzTETrainer_TestData td(out, m_test_x, thread_num(config)); 
 
   trainer->startup(out, config, m_train_x, v_train_y, featInfo, v_fixed_dw, inp_ens); 
   eval->begin(config, trainer->lossType()); 
@@ -208,7 +208,7 @@ void AzTETproc::train_predict(const AzOut &out,
                         /*---  for warm start  ---*/
                         AzTreeEnsemble *inp_ens) /* may be NULL */
 {
-  AzTETrainer_TestData td(out, m_test_x); 
+  AzTETrainer_TestData td(out, m_test_x, thread_num(config)); 
 
   int model_num = 0; 
   AzBytArr s_model_names; 
@@ -314,19 +314,33 @@ void AzTETproc::writePrediction(
 /*------------------------------------------------------------------*/
 void AzTETproc::writePrediction(const char *fn, 
                                 const AzDvect *v_p)
+{
+  AzFile file(fn); 
+  file.open("wb"); 
+  writePrediction(v_p, &file); 
+  file.close(true); 
+}
+
+/*------------------------------------------------------------------*/
+void AzTETproc::writePrediction(const AzDvect *v_p, 
+                                AzFile *file)
 {
   /* one prediction value per line */
+  /* written a block at a time; the buffer grows linearly, not geometrically */
   int width = 8; 
+  int flush_len = 65536; 
   AzBytArr s; 
   int dx; 
   for (dx = 0; dx < v_p->rowNum(); ++dx) {
     double val = v_p->get(dx); 
     s.concatFloat(val, width); 
     s.nl(); /* new line */
+    if (s.length() >= flush_len) {
+      s.writeText(file); 
+      s.reset(); 
+    }
   } 
-  AzFile file(fn); 
-  file.open("wb"); 
-  s.writeText(&file); 
+  s.writeText(file); 
 }
 
 /*------------------------------------------------------------------*/
@@ -414,22 +428,24 @@ void AzTETproc::xv(const AzOut &out,
     s.c(" #train: "); s.cn(trn_num); s.c(" #test: "); s.cn(tst_num); 
     AzTimeLog::print(s, out); 
    
-    AzSmat m_train_x(m_x->rowNum(), trn_num), m_test_x(m_x->rowNum(), tst_num); 
+    AzSmat m_train_x, m_test_x; 
     AzDvect v_train_y(trn_num), v_test_y(tst_num); 
     AzDvect v_fixed_dw; 
     if (!AzDvect::isNull(v_dw)) {
       v_fixed_dw.reform(trn_num); 
     }
+    AzIntArr ia_trn, ia_tst; 
+    ia_trn.prepare(trn_num); ia_tst.prepare(tst_num); 
     int trn_col=0, tst_col=0; 
 	int ix; 
     for (ix = 0; ix < nn; ++ix) {
       if (ix >= bx && ix < ex) {
-        m_test_x.col_u(tst_col)->set(m_x->col(ix)); 
+        ia_tst.put(ix); 
         v_test_y.set(tst_col, v_y->get(ix)); 
         ++tst_col; 
       }
       else {
-        m_train_x.col_u(trn_col)->set(m_x->col(ix)); 
+        ia_trn.put(ix); 
         v_train_y.set(trn_col, v_y->get(ix)); 
         if (!AzDvect::isNull(v_dw)) {
           v_fixed_dw.set(trn_col, v_dw->get(ix)); 
@@ -437,12 +453,15 @@ void AzTETproc::xv(const AzOut &out,
         ++trn_col; 
       }
     }
-    if (trn_col != m_train_x.colNum() || tst_col != m_test_x.colNum()) {
+    if (trn_col != trn_num || tst_col != tst_num) {
       throw new AzException(eyec, "dimension mismatch"); 
     }    
+    /*---  packed copies  ---*/
+    m_train_x.set(m_x, ia_trn.point(), ia_trn.size()); 
+    m_test_x.set(m_x, ia_tst.point(), ia_tst.size()); 
 
     /*---  ---*/
-    AzTETrainer_TestData td(out, &m_test_x); 
+    AzTETrainer_TestData td(out, &m_test_x, thread_num(config)); 
     trainer->startup(out, config, &m_train_x, &v_train_y, featInfo, 
                      &v_fixed_dw, NULL); 
     int seq = 0; 
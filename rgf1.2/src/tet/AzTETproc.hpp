@@ -25,6 +25,8 @@
 #include "AzIntPool.hpp"
 #include "AzTETrainer.hpp"
 #include "AzTET_Eval.hpp"
+#include "AzParam.hpp"
+#include "AzTETmain_kw.hpp"
 
 //! Call tree ensemble trainer.
 class AzTETproc {
@@ -131,6 +133,8 @@ public:
                            const AzOut &out); 
   static void writePrediction(const char *fn, 
                               const AzDvect *v_p); 
+  static void writePrediction(const AzDvect *v_p, 
+                              AzFile *file); 
   static void writeModelInfo(
                            const char *fn_stem, 
                            int seq_no, 
@@ -166,6 +170,13 @@ protected:
                                    const AzBytArr &s_model_names, 
                                    const char *out_model_names_fn, 
                                    const AzOut &out); 
+  /*---  test data is set up with the trainer's num_threads  ---*/
+  static int thread_num(const char *config) {
+    int num = 1; 
+    AzParam p(config, false); 
+    p.vInt(kw_read_thread_num, &num); 
+    return num; 
+  }
   inline static bool isSpecified(const char *str) { 
     if (str == NULL) return false; 
     if (strlen(str) <= 0) return false; 
@@ -36,20 +36,23 @@ enum AzTETrainer_Ret {
 class AzTETrainer; 
 class AzTETrainer_TestData {
 public:
-  AzTETrainer_TestData() : data(NULL), _t(0) {}
-  AzTETrainer_TestData(const AzOut &out, AzSmat *m_test_x) 
-                         : data(NULL), _t(0) { 
-    reset(out, m_test_x);  
+  AzTETrainer_TestData() : data(NULL), _t(0), _c(0) {}
+  AzTETrainer_TestData(const AzOut &out, AzSmat *m_test_x, int thread_num=1) 
+                         : data(NULL), _t(0), _c(0) { 
+    reset(out, m_test_x, thread_num);  
   }
   void reset(const AzOut &out, 
-             AzSmat *m_test_x) {
+             AzSmat *m_test_x, 
+             int thread_num=1) { /* for setting up; 0: as many as the cores */
     if (m_test_x == NULL) {
       throw new AzException("AzTETrainer_TestData::reset", "test input is null"); 
     }
-    data_dflt.reset_data_for_test(out, m_test_x); 
+    AzThreads threads; 
+    threads.reset(thread_num); 
+    data_dflt.reset_data_for_test(out, m_test_x, &threads); 
     data = &data_dflt; 
     m_test_x->destroy(); 
-    _t = 0; _b.reset(); _v.reform(0); 
+    _t = 0; _b.reset(); _v.reform(0); _w.reform(0); _c = 0; 
   }
 
   friend class AzTETrainer; 
@@ -61,6 +64,8 @@ protected:
   AzBmat _b;  //!< used by AzTETrainer only 
   AzDvect _v; //!< used by AzTETrainer only 
   int _t;     //!< used by AzTETrainer only 
+  AzDvect _w; //!< used by AzTETrainer only 
+  double _c;  //!< used by AzTETrainer only 
 }; 
 
 //! Abstract class: interface of Tree Ensemble Trainer (e.g., RGF, Gradient Boost, etc.)
@@ -103,6 +108,9 @@ public:
   //! Algorithm description. 
   virtual const char *description() const = 0;         
 
+  //! Make unknown parameters an error instead of a warning.  
+  virtual void rejectUnknownParam(bool doReject) = 0; 
+
 protected:
 
 /*------------------------------------------------------------------*/
@@ -151,6 +159,14 @@ protected:
   inline int *_t(AzTETrainer_TestData *td) const {
     return &td->_t; 
   }
+  //! to access AzTETrainer_TestData's work area for faster testing 
+  inline AzDvect *_w(AzTETrainer_TestData *td) const {
+    return &td->_w; 
+  }
+  //! to access AzTETrainer_TestData's work area for faster testing 
+  inline double *_c(AzTETrainer_TestData *td) const {
+    return &td->_c; 
+  }
 }; 
 
 #endif
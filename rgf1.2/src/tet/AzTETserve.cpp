@@ -0,0 +1,284 @@
+/* * * * *
+ *  AzTETserve.cpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#include "AzTETserve.hpp"
+#include "AzTools.hpp"
+
+#if !defined(_WIN32)
+#define _AZ_UNIX_SOCKET_
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+/*------------------------------------------------------------------*/
+void AzTETserve::reset(const AzStrPool *inp_sp_model_fn, 
+                       int inp_read_thread_num, 
+                       const AzOut &out)
+{
+  const char *eyec = "AzTETserve::reset"; 
+  a_flat.free(&flat); 
+  sp_model_fn.reset(); 
+  sp_model_fn.put(inp_sp_model_fn); 
+  read_thread_num = inp_read_thread_num; 
+  f_num = -1; 
+
+  model_num = sp_model_fn.size(); 
+  a_flat.alloc(&flat, model_num, eyec, "flat"); 
+  int mx; 
+  for (mx = 0; mx < model_num; ++mx) {
+    const char *model_fn = sp_model_fn.c_str(mx); 
+    AzTimeLog::print("Loading ", model_fn, out); 
+    flat[mx] = new AzTreeEnsemble_Flat(); 
+    flat[mx]->reset(model_fn); 
+    int dim = flat[mx]->orgdim(); 
+    if (dim <= 0) continue; 
+    if (f_num > 0 && f_num != dim) {
+      AzBytArr s(model_fn); s.c(" was trained with "); s.cn(dim); 
+      s.c(" features, whereas others were trained with "); s.cn(f_num); 
+      throw new AzException(AzInputError, eyec, s.c_str()); 
+    }
+    f_num = dim; 
+  }
+}
+
+/*------------------------------------------------------------------*/
+void AzTETserve::serve_stdio(const AzOut &out) 
+{
+  AzTimeLog::print("Reading requests from stdin ... ", out); 
+  serve_stream(stdin, stdout); 
+  AzTimeLog::print("Done ... ", out); 
+}
+
+/*------------------------------------------------------------------*/
+void AzTETserve::serve_socket(const char *socket_fn, 
+                              const AzOut &out) 
+{
+  const char *eyec = "AzTETserve::serve_socket"; 
+#ifdef _AZ_UNIX_SOCKET_
+  struct sockaddr_un addr; 
+  memset(&addr, 0, sizeof(addr)); 
+  addr.sun_family = AF_UNIX; 
+  if (strlen(socket_fn) >= sizeof(addr.sun_path)) {
+    throw new AzException(AzInputError, eyec, "The socket path is too long:", socket_fn); 
+  }
+  strcpy(addr.sun_path, socket_fn); 
+
+  int sock = socket(AF_UNIX, SOCK_STREAM, 0); 
+  if (sock < 0) {
+    throw new AzException(AzFileIOError, eyec, "Failed to create a socket"); 
+  }
+  unlink(socket_fn); /* left by a server that was killed */
+  if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || 
+      listen(sock, 16) != 0) {
+    close(sock); 
+    throw new AzException(AzFileIOError, eyec, "Failed to listen on", socket_fn); 
+  }
+  signal(SIGPIPE, SIG_IGN); /* a client may go away before reading the response */
+  AzTimeLog::print("Listening on ", socket_fn, out); 
+
+  for ( ; ; ) {
+    int conn = accept(sock, NULL, NULL); 
+    if (conn < 0) {
+      if (errno == EINTR) continue; 
+      close(sock); unlink(socket_fn); 
+      throw new AzException(AzFileIOError, eyec, "Failed to accept a connection on", socket_fn); 
+    }
+    FILE *inp = fdopen(conn, "r"); 
+    FILE *outp = fdopen(dup(conn), "w"); 
+    if (inp == NULL || outp == NULL) {
+      if (inp != NULL) fclose(inp); else close(conn); 
+      if (outp != NULL) fclose(outp); 
+      continue; 
+    }
+    bool doShutdown = serve_stream(inp, outp); 
+    fclose(inp); 
+    fclose(outp); 
+    if (doShutdown) break; 
+  }
+  close(sock); 
+  unlink(socket_fn); 
+  AzTimeLog::print("Done ... ", out); 
+#else
+  throw new AzException(AzInputError, eyec, "Unix domain sockets are not supported on this platform; use stdin and stdout instead"); 
+#endif
+}
+
+/*------------------------------------------------------------------*/
+bool AzTETserve::serve_stream(FILE *inp, FILE *outp) const
+{
+  for ( ; ; ) {
+    AzBytArr s_line; 
+    if (!readLine(inp, &s_line)) return false; /* end of input */
+    AzStrPool sp_tok; 
+    tokenize(&s_line, &sp_tok); 
+    if (sp_tok.size() <= 0) continue; 
+    const char *cmd = sp_tok.c_str(0); 
+    if (strcmp(cmd, "quit") == 0) return false; 
+    if (strcmp(cmd, "shutdown") == 0) return true; 
+
+    AzBytArr s_resp; 
+    try {
+      respond(&sp_tok, inp, &s_resp); 
+    }
+    catch (AzException *e) {
+      /*---  one line; the server keeps running  ---*/
+      AzBytArr s_msg(e->getMessage().c_str()); 
+      delete e; 
+      s_resp.reset("error"); 
+      const AzByte *wp = s_msg.point(), *msg_end = wp + s_msg.length(); 
+      for ( ; wp < msg_end; ) {
+        AzBytArr s_word; 
+        AzTools::getString(&wp, msg_end, &s_word); 
+        if (s_word.length() > 0) {
+          s_resp.c(" "); s_resp.c(&s_word); 
+        }
+      }
+      s_resp.nl(); 
+    }
+    fwrite(s_resp.point(), 1, s_resp.length(), outp); 
+    fflush(outp); 
+  }
+}
+
+/*------------------------------------------------------------------*/
+void AzTETserve::respond(const AzStrPool *sp_tok, 
+                         FILE *inp, 
+                         AzBytArr *s_resp) const
+{
+  const char *eyec = "AzTETserve::respond"; 
+  const char *cmd = sp_tok->c_str(0); 
+  if (strcmp(cmd, "file") == 0) {
+    if (sp_tok->size() != 2) {
+      throw new AzException(AzInputError, eyec, "Usage: file <path>"); 
+    }
+    AzSvDataS dataset; 
+    dataset.set_thread_num(read_thread_num); 
+    dataset.read_features_only(sp_tok->c_str(1)); 
+    check_featNum(dataset.featNum()); 
+    predict(dataset.feat(), s_resp); 
+  }
+  else if (strcmp(cmd, "rows") == 0) {
+    int num = (sp_tok->size() >= 2) ? atol(sp_tok->c_str(1)) : -1; 
+    bool isSparse = (sp_tok->size() == 3 && strcmp(sp_tok->c_str(2), "sparse") == 0); 
+    if (num < 0 || sp_tok->size() > 3 || (sp_tok->size() == 3 && !isSparse)) {
+      throw new AzException(AzInputError, eyec, "Usage: rows <n> [sparse]"); 
+    }
+    /*---  read all the lines before parsing to stay in sync on errors  ---*/
+    AzStrPool sp_lines; 
+    int dx; 
+    for (dx = 0; dx < num; ++dx) {
+      AzBytArr s_line; 
+      if (!readLine(inp, &s_line)) {
+        throw new AzException(AzInputError, eyec, "End of input before all the rows"); 
+      }
+      sp_lines.put(&s_line); 
+    }
+    AzSmat m_x; 
+    AzSvDataS::parseLines(&sp_lines, f_num, isSparse, &m_x); 
+    check_featNum(m_x.rowNum()); 
+    predict(&m_x, s_resp); 
+  }
+  else if (strcmp(cmd, "models") == 0) {
+    s_resp->reset("ok "); s_resp->cn(model_num); s_resp->nl(); 
+    int mx; 
+    for (mx = 0; mx < model_num; ++mx) {
+      s_resp->c(sp_model_fn.c_str(mx)); 
+      s_resp->c(" #tree="); s_resp->cn(flat[mx]->treeNum()); 
+      s_resp->c(" #feature="); s_resp->cn(flat[mx]->orgdim()); 
+      s_resp->nl(); 
+    }
+  }
+  else {
+    throw new AzException(AzInputError, eyec, "Unknown request:", cmd); 
+  }
+}
+
+/*------------------------------------------------------------------*/
+void AzTETserve::check_featNum(int inp_f_num) const
+{
+  if (f_num > 0 && f_num != inp_f_num) {
+    AzBytArr s("#feature in test data is "); s.cn(inp_f_num); 
+    s.c(", whereas #feature in training data was "); s.cn(f_num); 
+    throw new AzException(AzInputError, "AzTETserve::check_featNum", s.c_str()); 
+  }
+}
+
+/*------------------------------------------------------------------*/
+void AzTETserve::predict(const AzSmat *m_x, 
+                         AzBytArr *s_resp) const
+{
+  int data_num = m_x->colNum(); 
+  AzDataArray<AzDvect> av_p(model_num); 
+  int mx; 
+  for (mx = 0; mx < model_num; ++mx) {
+    flat[mx]->apply(m_x, av_p.point_u(mx)); 
+  }
+
+  /*---  same digits as the prediction files  ---*/
+  int width = 8; 
+  s_resp->reset("ok "); s_resp->cn(data_num); s_resp->c(" "); s_resp->cn(model_num); 
+  s_resp->nl(); 
+  int dx; 
+  for (dx = 0; dx < data_num; ++dx) {
+    for (mx = 0; mx < model_num; ++mx) {
+      if (mx > 0) s_resp->c(" "); 
+      s_resp->concatFloat(av_p.point(mx)->get(dx), width); 
+    }
+    s_resp->nl(); 
+  }
+}
+
+/*------------------------------------------------------------------*/
+/* returns false at the end of input; the new line is removed       */
+/*------------------------------------------------------------------*/
+bool AzTETserve::readLine(FILE *inp, AzBytArr *s_line)
+{
+  s_line->reset(); 
+  char buff[4096]; 
+  bool isEmpty = true; 
+  for ( ; ; ) {
+    if (fgets(buff, sizeof(buff), inp) == NULL) {
+      return !isEmpty; 
+    }
+    isEmpty = false; 
+    int len = Az64::cstrlen(buff); 
+    if (len > 0 && buff[len-1] == '\n') {
+      --len; 
+      if (len > 0 && buff[len-1] == '\r') --len; 
+      s_line->c((AzByte *)buff, len); 
+      return true; 
+    }
+    s_line->c((AzByte *)buff, len); 
+  }
+}
+
+/*------------------------------------------------------------------*/
+void AzTETserve::tokenize(const AzBytArr *s_line, AzStrPool *sp_tok)
+{
+  const AzByte *wp = s_line->point(), *line_end = wp + s_line->length(); 
+  for ( ; wp < line_end; ) {
+    AzBytArr s_tok; 
+    AzTools::getString(&wp, line_end, &s_tok); 
+    if (s_tok.length() > 0) {
+      sp_tok->put(&s_tok); 
+    }
+  }
+}
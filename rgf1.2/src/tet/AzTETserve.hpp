@@ -0,0 +1,84 @@
+/* * * * *
+ *  AzTETserve.hpp 
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#ifndef _AZ_TET_SERVE_HPP_
+#define _AZ_TET_SERVE_HPP_
+
+#include <cstdio>
+#include "AzUtil.hpp"
+#include "AzStrPool.hpp"
+#include "AzSvDataS.hpp"
+#include "AzTreeEnsemble_Flat.hpp"
+
+//! Keep models loaded and answer prediction requests.
+/**
+  *  Requests and responses are lines of text, read from stdin and written
+  *  to stdout, or exchanged over a Unix domain socket one client at a time.
+  *  
+  *  Requests: 
+  *    file <path>          : data file (text or binary, as in "predict")
+  *    rows <n> [sparse]    : followed by n lines in the data file format
+  *    models               : list the models
+  *    quit                 : end this client (stdin: end the server)
+  *    shutdown             : end the server
+  *  Responses: 
+  *    ok <n> <m>           : followed by n lines of m predictions each, 
+  *                           one column per model in the order loaded
+  *    error <message>
+ **/
+class AzTETserve {
+protected:
+  AzObjPtrArray<AzTreeEnsemble_Flat> a_flat; 
+  AzTreeEnsemble_Flat **flat; 
+  int model_num; 
+  AzStrPool sp_model_fn; 
+  int f_num; /* feature dimensionality of the models; -1: unknown */
+  int read_thread_num; 
+
+public:
+  AzTETserve() : flat(NULL), model_num(0), f_num(-1), read_thread_num(1) {}
+  ~AzTETserve() {
+    a_flat.free(&flat); 
+  }
+
+  void reset(const AzStrPool *sp_model_fn, 
+             int read_thread_num, 
+             const AzOut &out); 
+  inline int modelNum() const { return model_num; }
+
+  void serve_stdio(const AzOut &out); 
+  void serve_socket(const char *socket_fn, 
+                    const AzOut &out); 
+
+protected:
+  /*---  returns true if "shutdown" is requested  ---*/
+  bool serve_stream(FILE *inp, FILE *outp) const; 
+  void respond(const AzStrPool *sp_tok, 
+               FILE *inp, 
+               AzBytArr *s_resp) const; 
+  void predict(const AzSmat *m_x, 
+               AzBytArr *s_resp) const; 
+  void check_featNum(int inp_f_num) const; 
+  static bool readLine(FILE *inp, AzBytArr *s_line); 
+  static void tokenize(const AzBytArr *s_line, AzStrPool *sp_tok); 
+
+  /*---  prohibit copying  ---*/
+  AzTETserve(const AzTETserve &); 
+  AzTETserve & operator =(const AzTETserve &); 
+}; 
+#endif
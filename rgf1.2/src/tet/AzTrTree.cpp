@@ -23,6 +23,7 @@
 /*--------------------------------------------------------*/
 void AzTrTree::_release()
 {
+  _recycleWork(); 
   ia_root_dx.reset(); 
   a_node.free(&nodes); nodes_used = 0; 
   a_split.free(&split); 
@@ -35,10 +36,31 @@ void AzTrTree::_release()
 /*--------------------------------------------------------*/
 void AzTrTree::_releaseWork()
 {
+  _recycleWork(); 
   a_split.free(&split); 
   a_sorted_arr.free(&sorted_arr);
 }
 
+/*--------------------------------------------------------*/
+/* give split info and sorted arrays back to the pool in  */
+/* bulk so that the trees grown later can reuse them      */
+/*--------------------------------------------------------*/
+void AzTrTree::_recycleWork()
+{
+  if (pool == NULL) return; 
+  int nx; 
+  if (split != NULL) {
+    for (nx = 0; nx < a_split.size(); ++nx) {
+      if (split[nx] != NULL) release_split(nx); 
+    }
+  }
+  if (sorted_arr != NULL) {
+    for (nx = 0; nx < a_sorted_arr.size(); ++nx) {
+      if (sorted_arr[nx] != NULL) release_sorted_arr(nx); 
+    }
+  }
+}
+
 /*--------------------------------------------------------*/
 double AzTrTree::getRule(int inp_nx, 
                         AzTreeRule *rule) const
@@ -195,26 +217,32 @@ void AzTrTree::_splitNode(const AzDataForTrTree *data,
 
   AzIntArr ia_le, ia_gt; 
   const AzSortedFeatArr *s_arr = sorted_arr[nx]; 
-  if (s_arr == NULL) {
-    if (nx == root_nx) {
-      s_arr = data->sorted_array(); 
+  if (data->histBins() != NULL) { /* no sorted arrays with histograms */
+    data->getIndexes(inp->fx, nodes[nx].dxs, nodes[nx].dxs_num, inp->border_val, 
+                     &ia_le, &ia_gt); 
+  }
+  else {
+    if (s_arr == NULL) {
+      if (nx == root_nx) {
+        s_arr = data->sorted_array(); 
+      }
+      else {
+        throw new AzException("AzTrTree::_splitNode", "sorted_arr[nx]=null"); 
+      }
+    }
+    const AzSortedFeat *sorted = s_arr->sorted(inp->fx); 
+    if (sorted == NULL) {
+      AzSortedFeatWork tmp; 
+      const AzSortedFeat *my_sorted = sorted_arr[nx]->sorted(data->sorted_array(), 
+                                      inp->fx, &tmp); 
+      my_sorted->getIndexes(nodes[nx].dxs, nodes[nx].dxs_num, inp->border_val, 
+                            &ia_le, &ia_gt); 
     }
     else {
-      throw new AzException("AzTrTree::_splitNode", "sorted_arr[nx]=null"); 
+      sorted->getIndexes(nodes[nx].dxs, nodes[nx].dxs_num, inp->border_val, 
+                         &ia_le, &ia_gt); 
     }
   }
-  const AzSortedFeat *sorted = s_arr->sorted(inp->fx); 
-  if (sorted == NULL) {
-    AzSortedFeatWork tmp; 
-    const AzSortedFeat *my_sorted = sorted_arr[nx]->sorted(data->sorted_array(), 
-                                    inp->fx, &tmp); 
-    my_sorted->getIndexes(nodes[nx].dxs, nodes[nx].dxs_num, inp->border_val, 
-                          &ia_le, &ia_gt); 
-  }
-  else {
-    sorted->getIndexes(nodes[nx].dxs, nodes[nx].dxs_num, inp->border_val, 
-                       &ia_le, &ia_gt); 
-  }
 
   int le_offset = nodes[nx].dxs_offset; 
   int gt_offset = le_offset + ia_le.size(); 
@@ -252,7 +280,7 @@ void AzTrTree::_splitNode(const AzDataForTrTree *data,
   dump_split(inp, nx, org_weight, out); 
 
   /*---  release split info for the node we just split  ---*/
-  delete split[nx]; split[nx] = NULL; 
+  release_split(nx); 
 }
 
 /*--------------------------------------------------------*/
@@ -762,6 +790,9 @@ const AzSortedFeatArr *AzTrTree::sorted_array(int nx,
   }
 
   _checkNode(nx, "sortedFeat"); 
+  if (data->histBins() != NULL) {
+    return NULL; /* histograms are used instead */
+  }
   if (sorted_arr == NULL) {
     throw new AzException(eyec, "no sorted_arr"); 
   }
@@ -782,8 +813,9 @@ const AzSortedFeatArr *AzTrTree::sorted_array(int nx,
 #else
     if (nodes[nx].dxs_num != data->dataNum()) {
       /*---  Allow sampling  ---*/
-      sorted_arr[nx] = new AzSortedFeatArr(data->sorted_array(), 
-                                           nodes[nx].dxs, nodes[nx].dxs_num); 
+      sorted_arr[nx] = new_sorted_arr(true); 
+      sorted_arr[nx]->filter_base(data->sorted_array(), 
+                                  nodes[nx].dxs, nodes[nx].dxs_num); 
       return sorted_arr[nx]; 
     }
     else {
@@ -794,7 +826,8 @@ const AzSortedFeatArr *AzTrTree::sorted_array(int nx,
 
   if (sorted_arr[root_nx] == NULL) {
     /*---  we need this as the base for SortedFeat_Dense  ---*/
-    sorted_arr[root_nx] = new AzSortedFeatArr(data->sorted_array());     
+    sorted_arr[root_nx] = new_sorted_arr(true); 
+    sorted_arr[root_nx]->copy_base(data->sorted_array()); 
   }
   int px = nodes[nx].parent_nx; 
   if (px < 0) {
@@ -814,14 +847,14 @@ const AzSortedFeatArr *AzTrTree::sorted_array(int nx,
   if (sorted_arr[le_nx] != NULL || sorted_arr[gt_nx] != NULL) {
     throw new AzException(eyec, "one child has sorted_arr and the other doesn't?!"); 
   }
-  sorted_arr[le_nx] = new AzSortedFeatArr(); 
-  sorted_arr[gt_nx] = new AzSortedFeatArr(); 
+  sorted_arr[le_nx] = new_sorted_arr(false); 
+  sorted_arr[gt_nx] = new_sorted_arr(false); 
   AzSortedFeatArr::separate(base, inp, 
                             nodes[le_nx].dxs, nodes[le_nx].dxs_num, 
                             nodes[gt_nx].dxs, nodes[gt_nx].dxs_num, 
                             sorted_arr[le_nx], sorted_arr[gt_nx]); 
   if (px != root_nx) { /* can't delete the one at the root as it's the base */
-    delete sorted_arr[px]; sorted_arr[px] = NULL; 
+    release_sorted_arr(px); 
   }
 
   return sorted_arr[nx]; 
@@ -31,6 +31,19 @@
 #include "AzTrTreeNode.hpp"
 #include "AzTree.hpp"
 
+//! Work areas of the nodes of the trees being grown; recycled instead of deleted.  
+class AzTrTreeWorkPool {
+public:
+  AzObjPool<AzTrTsplit> split; 
+  AzObjPool<AzSortedFeatArr> sorted_arr;  /* below the root */
+  AzObjPool<AzSortedFeatArr> sorted_base; /* at the root; keeps the buffer of sorted indexes */
+  void reset() {
+    split.reset(); 
+    sorted_arr.reset(); 
+    sorted_base.reset(); 
+  }
+}; 
+
 /*---------------------------------------------*/
 /* Abstract class: Trainable Tree              */
 /* Derived classes: AzStdTree, AzRgfTree       */
@@ -57,10 +70,12 @@ protected:
   int curr_min_pop, curr_max_depth; 
   bool isBagging; 
 
+  AzTrTreeWorkPool *pool; /* may be NULL; not owned */
+
 public:
   AzTrTree() : 
     nodes_used(0), nodes(NULL), split(NULL), sorted_arr(NULL), root_nx(AzNone), 
-    curr_min_pop(-1), curr_max_depth(-1), isBagging(false) {}
+    curr_min_pop(-1), curr_max_depth(-1), isBagging(false), pool(NULL) {}
 
   /*---  derived classes must implement these             ---*/
   /*---------------------------------------------------------*/
@@ -147,10 +162,39 @@ public:
   /*---  to store data indexes to disk  ---*/
   virtual void forStoringDataIndexes(AzFile *file) {}
   virtual int estimateSizeofDataIndexes(int data_num) {return -1;}
+
+  /*---  to recycle split info and sorted arrays instead of new/delete  ---*/
+  virtual void forRecyclingWork(AzTrTreeWorkPool *inp_pool) {
+    pool = inp_pool; 
+  }
 protected:
   /*---  tools for derived classes; for building a tree  ---*/
   void _release(); 
   void _releaseWork(); 
+  void _recycleWork(); 
+
+  inline AzTrTsplit *new_split() const {
+    if (pool == NULL) return new AzTrTsplit(); 
+    AzTrTsplit *ptr = pool->split.get(); 
+    ptr->reset(); 
+    return ptr; 
+  }
+  inline void release_split(int nx) const {
+    if (pool == NULL) delete split[nx]; 
+    else              pool->split.put(split[nx]); 
+    split[nx] = NULL; 
+  }
+  inline AzSortedFeatArr *new_sorted_arr(bool isBase) const {
+    if (pool == NULL) return new AzSortedFeatArr(); 
+    if (isBase) return pool->sorted_base.get(); 
+    else        return pool->sorted_arr.get(); 
+  }
+  inline void release_sorted_arr(int nx) const {
+    if (pool == NULL)       delete sorted_arr[nx]; 
+    else if (nx == root_nx) pool->sorted_base.put(sorted_arr[nx]); 
+    else                    pool->sorted_arr.put(sorted_arr[nx]); 
+    sorted_arr[nx] = NULL; 
+  }
   int _newNode(int max_size); 
   void _genRoot(int max_size, const AzDataForTrTree *data, 
                 const AzIntArr *ia_dx=NULL); 
@@ -105,6 +105,7 @@ protected:
   const char *dt_param; 
 
   AzTemp_forTrTreeEns<T> temp_files; 
+  AzTrTreeWorkPool work_pool; /* shared by the trees being grown */
 
 public:
   AzTrTreeEnsemble() : t(NULL), t_num(0), const_val(0), org_dim(-1), dt_param("") {}
@@ -120,6 +121,7 @@ public:
     s_param.reset(); 
     dt_param = ""; 
     temp_files.reset(); 
+    work_pool.reset(); 
   }
   inline void cold_start(
                     AzParam &param, 
@@ -168,6 +170,7 @@ public:
     AzParam p(dt_param, false); 
     t[tx] = new T(p); 
     t[tx]->forStoringDataIndexes(temp_files.point_file()); 
+    t[tx]->forRecyclingWork(&work_pool); 
     ++t_num; 
     if (out_tx != NULL) {
       *out_tx = tx; 
@@ -312,6 +315,7 @@ public:
     for (tx = 0; tx < t_num; ++tx) {
       t[tx] = new T(p); 
       t[tx]->forStoringDataIndexes(temp_files.point_file()); 
+      t[tx]->forRecyclingWork(&work_pool); 
       if (search_t_num > 0 && tx < t_num-search_t_num) {
         t[tx]->quick_warmup(inp_ens->tree(tx), data, v_p, ia_tr_dx); 
       }
@@ -23,6 +23,12 @@
 #include "AzDmat.hpp"
 
 //! Targets and data point weights for node split search.  
+/**
+  *  With single precision, float copies of tar*dw and dw are kept so that 
+  *  split search gathers half as many bytes per data point; they must be 
+  *  re-synchronized (sync_single) when tar*dw or dw is updated through 
+  *  tarDw_forUpdate|dw_forUpdate, unless the float copies are updated too.  
+ **/
 /*--------------------------------------------------------*/
 class AzTrTtarget {
 protected:
@@ -31,10 +37,13 @@ protected:
   AzDvect v_fixed_dw; /* data point weights assigned by users */
   double fixed_dw_sum; 
 
+  bool doSingle; 
+  AzFvect f_tar_dw, f_dw; /* float copies of v_tar_dw and v_dw if doSingle */
+
 public:
-  AzTrTtarget() : fixed_dw_sum(-1) {}
+  AzTrTtarget() : fixed_dw_sum(-1), doSingle(false) {}
   AzTrTtarget(const AzDvect *inp_v_y, 
-              const AzDvect *inp_v_fixed_dw=NULL) {
+              const AzDvect *inp_v_fixed_dw=NULL) : doSingle(false) {
     reset(inp_v_y, inp_v_fixed_dw); 
   }
   void reset(const AzDvect *inp_v_y, 
@@ -54,6 +63,24 @@ public:
       }
       fixed_dw_sum = v_fixed_dw.sum(); 
     }
+    sync_single(); 
+  }
+  inline void setSingle(bool inp_doSingle) {
+    doSingle = inp_doSingle; 
+    sync_single(); 
+  }
+  inline bool isSingle() const {
+    return doSingle; 
+  }
+  void sync_single() {
+    if (doSingle) {
+      f_tar_dw.set(&v_tar_dw); 
+      f_dw.set(&v_dw); 
+    }
+    else {
+      f_tar_dw.reset(); 
+      f_dw.reset(); 
+    }
   }
   inline bool isWeighted() const {
     return !AzDvect::isNull(&v_fixed_dw); 
@@ -63,12 +90,14 @@ public:
   }
   inline void weight_tarDw() {
     v_tar_dw.scale(&v_fixed_dw); 
+    if (doSingle) f_tar_dw.set(&v_tar_dw); 
   }
   inline void weight_dw() {
     v_dw.scale(&v_fixed_dw); 
+    if (doSingle) f_dw.set(&v_dw); 
   }
 
-  AzTrTtarget(const AzTrTtarget *inp) {
+  AzTrTtarget(const AzTrTtarget *inp) : fixed_dw_sum(-1), doSingle(false) {
     reset(inp); 
   }
 
@@ -79,6 +108,9 @@ public:
       v_y.set(&inp->v_y); 
       v_fixed_dw.set(&inp->v_fixed_dw); 
       fixed_dw_sum = inp->fixed_dw_sum; 
+      doSingle = inp->doSingle; 
+      f_tar_dw.set(&inp->f_tar_dw); 
+      f_dw.set(&inp->f_dw); 
     }
   }
 
@@ -86,10 +118,12 @@ public:
     v_tar_dw.set(v_tar); 
     v_dw.set(inp_v_dw); 
     v_tar_dw.scale(&v_dw); /* component-wise multiplication */
+    sync_single(); 
   }
   void resetTarDw_residual(const AzDvect *v_p) { /* only for LS */
     v_tar_dw.set(&v_y); 
     v_tar_dw.add(v_p, -1); 
+    if (doSingle) f_tar_dw.set(&v_tar_dw); 
   }
   inline const double *dw_arr() const {
     return v_dw.point(); 
@@ -97,6 +131,19 @@ public:
   inline const double *tarDw_arr() const {
     return v_tar_dw.point(); 
   }
+  /*---  NULL unless single precision  ---*/
+  inline const float *dw_arr_f() const {
+    return (doSingle) ? f_dw.point() : NULL; 
+  }
+  inline const float *tarDw_arr_f() const {
+    return (doSingle) ? f_tar_dw.point() : NULL; 
+  }
+  inline float *dw_f_forUpdate() {
+    return (doSingle) ? f_dw.point_u() : NULL; 
+  }
+  inline float *tarDw_f_forUpdate() {
+    return (doSingle) ? f_tar_dw.point_u() : NULL; 
+  }
   inline const AzDvect *y() const {
     return &v_y; 
   }
@@ -116,9 +163,11 @@ public:
     return &v_dw; 
   }
   inline double getTarDwSum(const int *dxs, int dxs_num) const {
+    if (doSingle) return sum_f(f_tar_dw.point(), dxs, dxs_num); 
     return v_tar_dw.sum(dxs, dxs_num); 
   }
   inline double getDwSum(const int *dxs, int dxs_num) const {
+    if (doSingle) return sum_f(f_dw.point(), dxs, dxs_num); 
     return v_dw.sum(dxs, dxs_num); 
   }
   inline double getTarDwSum(const AzIntArr *ia_dx=NULL) const {
@@ -131,5 +180,13 @@ public:
   int dim() const {
     return v_tar_dw.rowNum(); 
   }
+
+protected:
+  static double sum_f(const float *val, const int *dxs, int dxs_num) {
+    double sum = 0; 
+    int ix; 
+    for (ix = 0; ix < dxs_num; ++ix) sum += val[dxs[ix]]; 
+    return sum; 
+  }
 }; 
 #endif 
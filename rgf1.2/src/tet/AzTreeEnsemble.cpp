@@ -17,6 +17,7 @@
  * * * * */
 
 #include "AzTreeEnsemble.hpp"
+#include "AzTreeEnsemble_Flat.hpp"
 #include "AzPrint.hpp"
 
 static int reserved_length = 256; 
@@ -104,13 +105,8 @@ void AzTreeEnsemble::_read(AzFile *file)
 void AzTreeEnsemble::apply(const AzSmat *m_data, 
                            AzDvect *v_pred) const
 {
-  int data_num = m_data->colNum(); 
-  v_pred->reform(data_num); 
-  double *pred = v_pred->point_u(); 
-  int dx;  
-  for (dx = 0; dx < data_num; ++dx) {
-    pred[dx] = apply(m_data->col(dx)); 
-  }
+  AzTreeEnsemble_Flat flat(this); 
+  flat.apply(m_data, v_pred); 
 }
 
 /*--------------------------------------------------------*/
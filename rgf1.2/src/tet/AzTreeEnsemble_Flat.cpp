@@ -0,0 +1,760 @@
+/* * * * *
+ *  AzTreeEnsemble_Flat.cpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#include "AzTreeEnsemble_Flat.hpp"
+#include "AzParam.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define _AZ_FLAT_SIMD_
+#include <immintrin.h>
+#endif
+
+/*--------------------------------------------------------*/
+/* static */
+AzFlatSimd AzTreeEnsemble_Flat::detect_simd()
+{
+#ifdef _AZ_FLAT_SIMD_
+  static AzFlatSimd detected = 
+    (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) ? AzFlatSimd_AVX512 : 
+    (__builtin_cpu_supports("avx2")) ? AzFlatSimd_AVX2 : AzFlatSimd_None; 
+  return detected; 
+#else
+  return AzFlatSimd_None; 
+#endif
+}
+
+#ifdef _AZ_FLAT_SIMD_
+/*--------------------------------------------------------*/
+/* 8 rows as two groups of 4; x: row#i starts at x+i*stride */
+__attribute__((target("avx2")))
+static void traverse8_avx2(const long long *fx_gt, const double *border, 
+                           int root_nx, 
+                           const double *x, int stride, 
+                           double *pred) /* inout: 8 values */
+{
+  const __m128i minus_one = _mm_set1_epi32(-1); 
+  const __m128i one = _mm_set1_epi32(1); 
+  const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6); 
+  const __m256i odd = _mm256_setr_epi32(1, 3, 5, 7, 1, 3, 5, 7); 
+  __m128i nx[2], offs[2]; 
+  nx[0] = nx[1] = _mm_set1_epi32(root_nx); 
+  offs[0] = _mm_setr_epi32(0, stride, stride*2, stride*3); 
+  offs[1] = _mm_add_epi32(offs[0], _mm_set1_epi32(stride*4)); 
+  for ( ; ; ) {
+    bool isDone = true; 
+    int gx; 
+    for (gx = 0; gx < 2; ++gx) {
+      __m256i pair = _mm256_i32gather_epi64(fx_gt, nx[gx], 8); 
+      __m128i fx = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(pair, even)); 
+      __m128i active = _mm_cmpgt_epi32(fx, minus_one); /* not a leaf */
+      if (_mm_testz_si128(active, active)) continue; 
+      isDone = false; 
+      __m256d active_pd = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(active)); 
+      __m256d xv = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), x, 
+                                 _mm_add_epi32(offs[gx], fx), active_pd, 8); 
+      __m256d bv = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), border, 
+                                 nx[gx], active_pd, 8); 
+      __m256d le = _mm256_cmp_pd(xv, bv, _CMP_LE_OQ); 
+      __m128i le32 = _mm256_castsi256_si128(
+                     _mm256_permutevar8x32_epi32(_mm256_castpd_si256(le), even)); 
+      __m128i gt = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(pair, odd)); 
+      __m128i next = _mm_blendv_epi8(gt, _mm_add_epi32(nx[gx], one), le32); 
+      nx[gx] = _mm_blendv_epi8(nx[gx], next, active); 
+    }
+    if (isDone) break; 
+  }
+  int gx; 
+  for (gx = 0; gx < 2; ++gx) {
+    __m256d leaf_val = _mm256_i32gather_pd(border, nx[gx], 8); 
+    _mm256_storeu_pd(pred+gx*4, _mm256_add_pd(_mm256_loadu_pd(pred+gx*4), leaf_val)); 
+  }
+}
+
+/*--------------------------------------------------------*/
+/* 16 rows as two groups of 8 */
+__attribute__((target("avx512f,avx512vl")))
+static void traverse16_avx512(const long long *fx_gt, const double *border, 
+                           int root_nx, 
+                           const double *x, int stride, 
+                           double *pred) /* inout: 16 values */
+{
+  const __m256i minus_one = _mm256_set1_epi32(-1); 
+  const __m256i one = _mm256_set1_epi32(1); 
+  __m256i nx[2], offs[2]; 
+  nx[0] = nx[1] = _mm256_set1_epi32(root_nx); 
+  offs[0] = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), 
+                               _mm256_set1_epi32(stride)); 
+  offs[1] = _mm256_add_epi32(offs[0], _mm256_set1_epi32(stride*8)); 
+  for ( ; ; ) {
+    bool isDone = true; 
+    int gx; 
+    for (gx = 0; gx < 2; ++gx) {
+      __m512i pair = _mm512_i32gather_epi64(nx[gx], fx_gt, 8); 
+      __m256i fx = _mm512_cvtepi64_epi32(pair); 
+      __mmask8 active = _mm256_cmpgt_epi32_mask(fx, minus_one); /* not a leaf */
+      if (active == 0) continue; 
+      isDone = false; 
+      __m512d xv = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), active, 
+                                 _mm256_add_epi32(offs[gx], fx), x, 8); 
+      __m512d bv = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), active, 
+                                 nx[gx], border, 8); 
+      __mmask8 le = _mm512_mask_cmp_pd_mask(active, xv, bv, _CMP_LE_OQ); 
+      __m256i gt = _mm512_cvtepi64_epi32(_mm512_srli_epi64(pair, 32)); 
+      __m256i next = _mm256_mask_blend_epi32(le, gt, _mm256_add_epi32(nx[gx], one)); 
+      nx[gx] = _mm256_mask_blend_epi32(active, nx[gx], next); 
+    }
+    if (isDone) break; 
+  }
+  int gx; 
+  for (gx = 0; gx < 2; ++gx) {
+    __m512d leaf_val = _mm512_i32gather_pd(nx[gx], border, 8); 
+    _mm512_storeu_pd(pred+gx*8, _mm512_add_pd(_mm512_loadu_pd(pred+gx*8), leaf_val)); 
+  }
+}
+#endif
+
+/*--------------------------------------------------------*/
+void AzTreeEnsemble_Flat::release()
+{
+  mfile.close(); 
+  ia_fx_gt.reset(); 
+  v_border.reform(0); 
+  ia_root.reset(); 
+  ia_org2fx.reset(); 
+  fx_gt = NULL; border = NULL; root = NULL; org2fx = NULL; 
+  node_num = root_num = 0; 
+  used_f_num = org_f_num = 0; 
+  const_val = 0; 
+  tree_num = leaf_num = 0; 
+  org_dim = -1; 
+  s_config.reset(); 
+  s_sign.reset(); 
+}
+
+/*--------------------------------------------------------*/
+void AzTreeEnsemble_Flat::info(AzTE_ModelInfo *out_info) const
+{
+  if (out_info == NULL) return; 
+  out_info->leaf_num = leaf_num; 
+  out_info->tree_num = tree_num; 
+  out_info->s_sign.reset(&s_sign); 
+  out_info->s_config.reset(&s_config); 
+}
+
+/*--------------------------------------------------------*/
+void AzTreeEnsemble_Flat::reset(const AzTreeEnsemble *ens)
+{
+  release(); 
+  const_val = ens->constant(); 
+  tree_num = ens->size(); 
+  leaf_num = ens->leafNum(); 
+  org_dim = ens->orgdim(); 
+  s_config.reset(ens->configuration()); 
+  s_sign.reset(ens->signature()); 
+
+  /*---  feature ids used by the trees  ---*/
+  int max_node_num = 0; 
+  org_f_num = 0; 
+  int tx; 
+  for (tx = 0; tx < ens->size(); ++tx) {
+    const AzTree *tree = ens->tree(tx); 
+    max_node_num += tree->nodeNum(); 
+    int nx; 
+    for (nx = 0; nx < tree->nodeNum(); ++nx) {
+      const AzTreeNode *np = tree->node(nx); 
+      if (!np->isLeaf()) org_f_num = MAX(org_f_num, np->fx+1); 
+    }
+  }
+  ia_org2fx.reset(org_f_num, -1); 
+  int *my_org2fx = ia_org2fx.point_u(); 
+  used_f_num = 0; 
+  for (tx = 0; tx < ens->size(); ++tx) {
+    const AzTree *tree = ens->tree(tx); 
+    int nx; 
+    for (nx = 0; nx < tree->nodeNum(); ++nx) {
+      const AzTreeNode *np = tree->node(nx); 
+      if (!np->isLeaf() && my_org2fx[np->fx] < 0) {
+        my_org2fx[np->fx] = used_f_num++; 
+      }
+    }
+  }
+
+  /*---  nodes  ---*/
+  ia_fx_gt.reset(); ia_fx_gt.prepare(max_node_num*2); 
+  v_border.reform(max_node_num); 
+  ia_root.reset(); 
+  for (tx = 0; tx < ens->size(); ++tx) {
+    const AzTree *tree = ens->tree(tx); 
+    if (tree->root() < 0) continue; /* empty tree */
+    ia_root.put(ia_fx_gt.size()/2); 
+    compile(tree, tree->root(), 0); 
+  }
+
+  fx_gt = ia_fx_gt.point(); 
+  border = v_border.point(); 
+  root = ia_root.point(); 
+  org2fx = ia_org2fx.point(); 
+  node_num = ia_fx_gt.size()/2; 
+  root_num = ia_root.size(); 
+}
+
+/*--------------------------------------------------------*/
+/* depth first */
+void AzTreeEnsemble_Flat::compile(const AzTree *tree,
+                                  int nx,
+                                  double path_sum)
+{
+  const char *eyec = "AzTreeEnsemble_Flat::compile"; 
+  if (nx < 0) {
+    throw new AzException(eyec, "stuck"); 
+  }
+  const AzTreeNode *np = tree->node(nx); 
+  path_sum += np->weight; /* in the same order as AzTree::apply */
+  int my_nx = ia_fx_gt.size()/2; 
+  if (my_nx >= v_border.rowNum()) {
+    throw new AzException(eyec, "more nodes than expected"); 
+  }
+  if (np->isLeaf()) {
+    ia_fx_gt.put(-1); 
+    ia_fx_gt.put(-1); 
+    v_border.set(my_nx, path_sum); 
+    return; 
+  }
+  ia_fx_gt.put(ia_org2fx.get(np->fx)); 
+  ia_fx_gt.put(-1); /* set below */
+  v_border.set(my_nx, np->border_val); 
+  compile(tree, np->le_nx, path_sum); 
+  ia_fx_gt.update(my_nx*2+1, ia_fx_gt.size()/2); 
+  compile(tree, np->gt_nx, path_sum); 
+}
+
+/*--------------------------------------------------------*/
+void AzTreeEnsemble_Flat::apply(const AzSmat *m_data,
+                                AzDvect *v_pred) const
+{
+  if (m_data->rowNum() < org_f_num) {
+    throw new AzException("AzTreeEnsemble_Flat::apply",
+                          "The model uses more features than the data has"); 
+  }
+  int data_num = m_data->colNum(); 
+  v_pred->reform(data_num); 
+  double *pred = v_pred->point_u(); 
+
+  /*---  dense block of rows; only the features used by the trees  ---*/
+  /*  (used_f_num <= #node, so block_size_min rows are not too many)  */
+  int rows = block_size_max; 
+  if (used_f_num > 0) {
+    rows = MAX(block_size_min, MIN(block_size_max, block_elm_max / used_f_num)); 
+  }
+  AzDvect v_block(rows*used_f_num); 
+  double *block = v_block.point_u(); 
+
+  int d0; 
+  for (d0 = 0; d0 < data_num; d0 += rows) {
+    int num = MIN(rows, data_num - d0); 
+    if (used_f_num > 0) {
+      memset(block, 0, sizeof(block[0])*num*used_f_num); 
+    }
+    AZint8 nz_num = 0; 
+    int rx; 
+    for (rx = 0; rx < num; ++rx) {
+      double *x = block + rx*used_f_num; 
+      const AzSvect *v_data = m_data->col(d0+rx); 
+      AzCursor cur; 
+      for ( ; ; ) {
+        double val; 
+        int row = v_data->next(cur, val); 
+        if (row < 0) break; 
+        if (row < org_f_num && org2fx[row] >= 0) {
+          x[org2fx[row]] = val; 
+          ++nz_num; 
+        }
+      }
+      pred[d0+rx] = const_val; 
+    }
+
+    /*---  vectors only if at least half the values are non-zero  ---*/
+    AzFlatSimd my_simd = simd; 
+    if (nz_num*2 < (AZint8)num*used_f_num) my_simd = AzFlatSimd_None; 
+
+    /*---  one pass over the rows of the block per tree  ---*/
+    int tx; 
+    for (tx = 0; tx < root_num; ++tx) {
+      int root_nx = root[tx]; 
+      rx = 0; 
+#ifdef _AZ_FLAT_SIMD_
+      if (my_simd == AzFlatSimd_AVX512) {
+        for ( ; rx+16 <= num; rx += 16) {
+          traverse16_avx512((const long long *)fx_gt, border, root_nx, block + rx*used_f_num, 
+                            used_f_num, pred+d0+rx); 
+        }
+      }
+      if (my_simd >= AzFlatSimd_AVX2) {
+        for ( ; rx+8 <= num; rx += 8) {
+          traverse8_avx2((const long long *)fx_gt, border, root_nx, block + rx*used_f_num, 
+                         used_f_num, pred+d0+rx); 
+        }
+      }
+#endif
+      for ( ; rx < num; ++rx) {
+        const double *x = block + rx*used_f_num; 
+        int nx = root_nx; 
+        int fx; 
+        while ((fx = fx_gt[nx*2]) >= 0) {
+          nx = (x[fx] <= border[nx]) ? nx+1 : fx_gt[nx*2+1]; 
+        }
+        pred[d0+rx] += border[nx]; 
+      }
+    }
+  }
+}
+
+/*--------------------------------------------------------*/
+/*  Flat model file: the header (AzFlatModelHeader) and    */
+/*  then the arrays as they are in memory, each padded to  */
+/*  8 bytes: fx_gt (int x #node*2), border (double x       */
+/*  #node), root (int x #root), org2fx (int x org_f_num),  */
+/*  configuration and signature (char).  It is written in  */
+/*  the native byte order so that it can be used in place; */
+/*  the marker detects a mismatch.                         */
+/*--------------------------------------------------------*/
+#define AzFlatModel_Magic "#AzFlat\n"
+static const int AzFlatModel_MagicLen = 8; 
+static const int AzFlatModel_Version = 1; 
+static const int AzFlatModel_Marker = 0x01020304; 
+
+static inline AZint8 _pad8(AZint8 len) {
+  return (len + 7) / 8 * 8; 
+}
+
+/*--------------------------------------------------------*/
+/* FNV-1a over 8-byte words; len must be a multiple of 8   */
+/* static */
+AZint8 AzTreeEnsemble_Flat::checksum(const AzByte *bytes, AZint8 len)
+{
+  unsigned long long h = 14695981039346656037ULL; 
+  AZint8 ix; 
+  for (ix = 0; ix+8 <= len; ix += 8) {
+    unsigned long long w; 
+    memcpy(&w, bytes+ix, 8); 
+    h ^= w; 
+    h *= 1099511628211ULL; 
+  }
+  return (AZint8)h; 
+}
+
+/*--------------------------------------------------------*/
+/* static */
+bool AzTreeEnsemble_Flat::isFlatModel(const char *fn)
+{
+  if (fn == NULL || !AzFile::isExisting(fn)) return false; 
+  AzFile file(fn); 
+  file.open("rb"); 
+  if (file.size() < AzFlatModel_MagicLen) {
+    file.close(); 
+    return false; 
+  }
+  char magic[AzFlatModel_MagicLen]; 
+  file.seekReadBytes(0, AzFlatModel_MagicLen, magic); 
+  file.close(); 
+  return (memcmp(magic, AzFlatModel_Magic, AzFlatModel_MagicLen) == 0); 
+}
+
+/*--------------------------------------------------------*/
+void AzTreeEnsemble_Flat::write(const char *fn) const
+{
+  const char *eyec = "AzTreeEnsemble_Flat::write"; 
+  AzFlatModelHeader hd; 
+  memset(&hd, 0, sizeof(hd)); 
+  memcpy(hd.magic, AzFlatModel_Magic, AzFlatModel_MagicLen); 
+  AzParam p(s_config.c_str(), false); 
+  AzBytArr s_loss; 
+  p.vStr("loss=", &s_loss); 
+  strncpy(hd.loss, s_loss.c_str(), sizeof(hd.loss)-1); 
+  hd.version = AzFlatModel_Version; 
+  hd.marker = AzFlatModel_Marker; 
+  hd.org_dim = org_dim; 
+  hd.org_f_num = org_f_num; 
+  hd.used_f_num = used_f_num; 
+  hd.tree_num = tree_num; 
+  hd.root_num = root_num; 
+  hd.node_num = node_num; 
+  hd.leaf_num = leaf_num; 
+  hd.config_len = s_config.length(); 
+  hd.sign_len = s_sign.length(); 
+  hd.const_val = const_val; 
+
+  /*---  body  ---*/
+  AZint8 len[6] = { 
+    (AZint8)sizeof(int)*node_num*2, (AZint8)sizeof(double)*node_num, 
+    (AZint8)sizeof(int)*root_num, (AZint8)sizeof(int)*org_f_num, 
+    hd.config_len, hd.sign_len }; 
+  const void *src[6] = { fx_gt, border, root, org2fx, 
+                         s_config.point(), s_sign.point() }; 
+  hd.body_len = 0; 
+  int ix; 
+  for (ix = 0; ix < 6; ++ix) hd.body_len += _pad8(len[ix]); 
+  AzBaseArray<AzByte,AZint8> a_body; 
+  AzByte *body = NULL; 
+  a_body.alloc(&body, MAX(hd.body_len, 8), eyec, "body"); 
+  memset(body, 0, hd.body_len); 
+  AZint8 offs = 0; 
+  for (ix = 0; ix < 6; ++ix) {
+    if (len[ix] > 0) memcpy(body+offs, src[ix], len[ix]); 
+    offs += _pad8(len[ix]); 
+  }
+  if (offs != hd.body_len) {
+    throw new AzException(eyec, "conflict in the body length"); 
+  }
+  hd.checksum = checksum(body, hd.body_len); 
+
+  AzFile file(fn); 
+  file.open("wb"); 
+  file.writeBytes(&hd, sizeof(hd)); 
+  file.writeBytes(body, hd.body_len); 
+  file.close(true); 
+}
+
+/*--------------------------------------------------------*/
+void AzTreeEnsemble_Flat::read(const char *fn)
+{
+  const char *eyec = "AzTreeEnsemble_Flat::read"; 
+  release(); 
+  mfile.open(fn); 
+  const AzByte *data = mfile.point(); 
+  AZint8 data_len = mfile.size(); 
+  if (data_len < (AZint8)sizeof(AzFlatModelHeader) || 
+      memcmp(data, AzFlatModel_Magic, AzFlatModel_MagicLen) != 0) {
+    throw new AzException(AzInputNotValid, eyec, "Not a flat model file: ", fn); 
+  }
+  const AzFlatModelHeader *hd = (const AzFlatModelHeader *)data; 
+  if (hd->marker != AzFlatModel_Marker) {
+    throw new AzException(AzInputNotValid, eyec, 
+          "Byte order mismatch; convert the model again on this machine: ", fn); 
+  }
+  if (hd->version != AzFlatModel_Version) {
+    throw new AzException(AzInputNotValid, eyec, "Unsupported version: ", fn); 
+  }
+  if (hd->node_num < 0 || hd->root_num < 0 || hd->root_num > hd->tree_num || 
+      hd->org_f_num < 0 || hd->used_f_num < 0 || hd->used_f_num > hd->org_f_num || 
+      hd->config_len < 0 || hd->sign_len < 0 || 
+      hd->body_len != data_len - (AZint8)sizeof(AzFlatModelHeader)) {
+    throw new AzException(AzInputNotValid, eyec, "Broken or truncated file: ", fn); 
+  }
+  AZint8 len[6] = { 
+    (AZint8)sizeof(int)*hd->node_num*2, (AZint8)sizeof(double)*hd->node_num, 
+    (AZint8)sizeof(int)*hd->root_num, (AZint8)sizeof(int)*hd->org_f_num, 
+    hd->config_len, hd->sign_len }; 
+  AZint8 body_len = 0; 
+  int ix; 
+  for (ix = 0; ix < 6; ++ix) body_len += _pad8(len[ix]); 
+  const AzByte *body = data + sizeof(AzFlatModelHeader); 
+  if (body_len != hd->body_len || 
+      checksum(body, body_len) != hd->checksum) {
+    throw new AzException(AzInputNotValid, eyec, "Checksum error; broken file: ", fn); 
+  }
+
+  const AzByte *ptr[6]; 
+  AZint8 offs = 0; 
+  for (ix = 0; ix < 6; ++ix) {
+    ptr[ix] = body + offs; 
+    offs += _pad8(len[ix]); 
+  }
+  fx_gt = (const int *)ptr[0]; 
+  border = (const double *)ptr[1]; 
+  root = (const int *)ptr[2]; 
+  org2fx = (const int *)ptr[3]; 
+  s_config.reset(ptr[4], hd->config_len); 
+  s_sign.reset(ptr[5], hd->sign_len); 
+  node_num = hd->node_num; 
+  root_num = hd->root_num; 
+  org_f_num = hd->org_f_num; 
+  used_f_num = hd->used_f_num; 
+  const_val = hd->const_val; 
+  tree_num = hd->tree_num; 
+  leaf_num = hd->leaf_num; 
+  org_dim = hd->org_dim; 
+
+  /*---  so that apply() never goes out of the arrays  ---*/
+  for (ix = 0; ix < root_num; ++ix) {
+    if (root[ix] < 0 || root[ix] >= node_num) {
+      throw new AzException(AzInputNotValid, eyec, "Broken root: ", fn); 
+    }
+  }
+  int nx; 
+  for (nx = 0; nx < node_num; ++nx) {
+    int fx = fx_gt[nx*2]; 
+    if (fx < 0) continue; 
+    if (fx >= used_f_num || nx+1 >= node_num || 
+        fx_gt[nx*2+1] <= nx || fx_gt[nx*2+1] >= node_num) {
+      throw new AzException(AzInputNotValid, eyec, "Broken node: ", fn); 
+    }
+  }
+  for (ix = 0; ix < org_f_num; ++ix) {
+    if (org2fx[ix] >= used_f_num) {
+      throw new AzException(AzInputNotValid, eyec, "Broken feature map: ", fn); 
+    }
+  }
+}
+
+/*--------------------------------------------------------*/
+/*--------------------------------------------------------*/
+/* Append the structure of the subtree at nx to s_key in  */
+/* depth-first order; returns the node# after the subtree */
+int AzTreeEnsemble_FlatBatch::walk(const AzTreeEnsemble_Flat *fl, int nx, 
+                                   const int *fx2org, 
+                                   AzBytArr *s_key) const
+{
+  int fx = fl->fx_gt[nx*2]; 
+  if (fx < 0) {
+    int leaf = -1; 
+    s_key->c((AzByte *)&leaf, sizeof(leaf)); 
+    return nx+1; 
+  }
+  int org_fx = fx2org[fx]; 
+  double border_val = fl->border[nx]; 
+  s_key->c((AzByte *)&org_fx, sizeof(org_fx)); 
+  s_key->c((AzByte *)&border_val, sizeof(border_val)); 
+  int next = walk(fl, nx+1, fx2org, s_key); 
+  if (fl->fx_gt[nx*2+1] != next) {
+    throw new AzException(AzInputNotValid, "AzTreeEnsemble_FlatBatch::walk", 
+                          "Nodes are not in depth-first order"); 
+  }
+  return walk(fl, next, fx2org, s_key); 
+}
+
+/*--------------------------------------------------------*/
+void AzTreeEnsemble_FlatBatch::reset(const AzStrPool *sp_model_fn)
+{
+  const char *eyec = "AzTreeEnsemble_FlatBatch::reset"; 
+  a_flat.free(&flat); 
+  model_num = sp_model_fn->size(); 
+  a_flat.alloc(&flat, model_num, eyec, "flat"); 
+  org_f_num = 0; 
+  int mx; 
+  for (mx = 0; mx < model_num; ++mx) {
+    flat[mx] = new AzTreeEnsemble_Flat(); 
+    flat[mx]->reset(sp_model_fn->c_str(mx)); 
+    org_f_num = MAX(org_f_num, flat[mx]->org_f_num); 
+  }
+
+  /*---  structure of every tree as a byte string  ---*/
+  AzDataArray<AzIntArr> aia_fx2org(model_num); 
+  AzStrPool sp_key; 
+  AzIntArr ia_tree_mx, ia_tree_end; 
+  ia_tree_beg.reset(); 
+  ia_tree_offs.reset(); /* model's root node# for now */
+  for (mx = 0; mx < model_num; ++mx) {
+    const AzTreeEnsemble_Flat *fl = flat[mx]; 
+    AzIntArr *ia_fx2org = aia_fx2org.point_u(mx); 
+    ia_fx2org->reset(fl->used_f_num, -1); 
+    int ox; 
+    for (ox = 0; ox < fl->org_f_num; ++ox) {
+      if (fl->org2fx[ox] >= 0) ia_fx2org->update(fl->org2fx[ox], ox); 
+    }
+    ia_tree_beg.put(ia_tree_mx.size()); 
+    int tx; 
+    for (tx = 0; tx < fl->root_num; ++tx) {
+      AzBytArr s_key; 
+      int end_nx = walk(fl, fl->root[tx], ia_fx2org->point(), &s_key); 
+      sp_key.put(&s_key); 
+      ia_tree_mx.put(mx); 
+      ia_tree_offs.put(fl->root[tx]); 
+      ia_tree_end.put(end_nx); 
+    }
+  }
+  ia_tree_beg.put(ia_tree_mx.size()); 
+
+  /*---  number the distinct ones in the order of appearance  ---*/
+  AzStrPool sp_uniq(&sp_key); 
+  sp_uniq.commit(); 
+  AzIntArr ia_uniq2s; 
+  ia_uniq2s.reset(sp_uniq.size(), -1); 
+  int tree_num = sp_key.size(); 
+  ia_tree_struct.reset(tree_num, -1); 
+  AzIntArr ia_s2tree; /* first tree with the structure */
+  int node_num = 0; 
+  int tx; 
+  for (tx = 0; tx < tree_num; ++tx) {
+    int len; 
+    const AzByte *key = sp_key.point(tx, &len); 
+    int ux = sp_uniq.find(key, len); 
+    if (ux < 0) throw new AzException(eyec, "key not found"); 
+    if (ia_uniq2s.get(ux) < 0) {
+      ia_uniq2s.update(ux, ia_s2tree.size()); 
+      ia_s2tree.put(tx); 
+      node_num += ia_tree_end.get(tx) - ia_tree_offs.get(tx); 
+    }
+    ia_tree_struct.update(tx, ia_uniq2s.get(ux)); 
+  }
+
+  /*---  copy the nodes of the distinct structures  ---*/
+  ia_org2fx.reset(org_f_num, -1); 
+  int *my_org2fx = ia_org2fx.point_u(); 
+  used_f_num = 0; 
+  ia_fx_gt.reset(); ia_fx_gt.prepare(node_num*2); 
+  v_border.reform(node_num); 
+  ia_root.reset(); 
+  int sx; 
+  for (sx = 0; sx < ia_s2tree.size(); ++sx) {
+    int rep_tx = ia_s2tree.get(sx); 
+    const AzTreeEnsemble_Flat *fl = flat[ia_tree_mx.get(rep_tx)]; 
+    const int *fx2org = aia_fx2org.point(ia_tree_mx.get(rep_tx))->point(); 
+    int root_nx = ia_tree_offs.get(rep_tx), end_nx = ia_tree_end.get(rep_tx); 
+    int my_root = ia_fx_gt.size()/2; 
+    ia_root.put(my_root); 
+    int nx; 
+    for (nx = root_nx; nx < end_nx; ++nx) {
+      int my_nx = ia_fx_gt.size()/2; 
+      int fx = fl->fx_gt[nx*2]; 
+      if (fx < 0) {
+        ia_fx_gt.put(-1); 
+        ia_fx_gt.put(-1); 
+        v_border.set(my_nx, (double)my_nx); 
+        continue; 
+      }
+      int org_fx = fx2org[fx]; 
+      if (my_org2fx[org_fx] < 0) my_org2fx[org_fx] = used_f_num++; 
+      ia_fx_gt.put(my_org2fx[org_fx]); 
+      ia_fx_gt.put(fl->fx_gt[nx*2+1] - root_nx + my_root); 
+      v_border.set(my_nx, fl->border[nx]); 
+    }
+  }
+
+  /*---  offset from a structure's node# to the model's  ---*/
+  for (tx = 0; tx < tree_num; ++tx) {
+    int sx = ia_tree_struct.get(tx); 
+    ia_tree_offs.update(tx, ia_tree_offs.get(tx) - ia_root.get(sx)); 
+  }
+}
+
+/*--------------------------------------------------------*/
+void AzTreeEnsemble_FlatBatch::apply(const AzSmat *m_data,
+                                     AzDataArray<AzDvect> *av_pred) const
+{
+  const char *eyec = "AzTreeEnsemble_FlatBatch::apply"; 
+  if (m_data->rowNum() < org_f_num) {
+    throw new AzException(eyec, "The models use more features than the data has"); 
+  }
+  int data_num = m_data->colNum(); 
+  av_pred->reset(model_num); 
+  AzBaseArray<double *> a_pred; 
+  double **pred = NULL; 
+  a_pred.alloc(&pred, model_num, eyec, "pred"); 
+  int mx; 
+  for (mx = 0; mx < model_num; ++mx) {
+    AzDvect *v_pred = av_pred->point_u(mx); 
+    v_pred->reform(data_num); 
+    pred[mx] = v_pred->point_u(); 
+  }
+
+  const int *fx_gt = ia_fx_gt.point(); 
+  const double *border = v_border.point(); 
+  const int *org2fx = ia_org2fx.point(); 
+  const int *tree_beg = ia_tree_beg.point(); 
+  const int *tree_struct = ia_tree_struct.point(); 
+  const int *tree_offs = ia_tree_offs.point(); 
+  int s_num = structNum(); 
+
+  int rows = block_size_max; 
+  if (used_f_num > 0) {
+    rows = MAX(block_size_min, MIN(block_size_max, block_elm_max / used_f_num)); 
+  }
+  if (s_num > 0) {
+    rows = MAX(block_size_min, MIN(rows, leaf_elm_max / s_num)); 
+  }
+  AzDvect v_block(rows*used_f_num); 
+  double *block = v_block.point_u(); 
+  AzDvect v_leaf(rows*s_num); /* leaf node# of each structure; as double for the vector code */
+  double *leaf = v_leaf.point_u(); 
+  int d0; 
+  for (d0 = 0; d0 < data_num; d0 += rows) {
+    int num = MIN(rows, data_num - d0); 
+    if (used_f_num > 0) {
+      memset(block, 0, sizeof(block[0])*num*used_f_num); 
+    }
+    AZint8 nz_num = 0; 
+    int rx; 
+    for (rx = 0; rx < num; ++rx) {
+      double *x = block + rx*used_f_num; 
+      const AzSvect *v_data = m_data->col(d0+rx); 
+      AzCursor cur; 
+      for ( ; ; ) {
+        double val; 
+        int row = v_data->next(cur, val); 
+        if (row < 0) break; 
+        if (row < org_f_num && org2fx[row] >= 0) {
+          x[org2fx[row]] = val; 
+          ++nz_num; 
+        }
+      }
+    }
+    AzFlatSimd my_simd = simd; 
+    if (nz_num*2 < (AZint8)num*used_f_num) my_simd = AzFlatSimd_None; 
+
+    /*---  each distinct structure once  ---*/
+    int sx; 
+    for (sx = 0; sx < s_num; ++sx) {
+      int root_nx = ia_root.get(sx); 
+      double *lf = leaf + sx*rows; 
+      rx = 0; 
+#ifdef _AZ_FLAT_SIMD_
+      if (my_simd != AzFlatSimd_None) {
+        memset(lf, 0, sizeof(lf[0])*num); /* + leaf value, which is the node# */
+      }
+      if (my_simd == AzFlatSimd_AVX512) {
+        for ( ; rx+16 <= num; rx += 16) {
+          traverse16_avx512((const long long *)fx_gt, border, root_nx, block + rx*used_f_num, 
+                            used_f_num, lf+rx); 
+        }
+      }
+      if (my_simd >= AzFlatSimd_AVX2) {
+        for ( ; rx+8 <= num; rx += 8) {
+          traverse8_avx2((const long long *)fx_gt, border, root_nx, block + rx*used_f_num, 
+                         used_f_num, lf+rx); 
+        }
+      }
+#endif
+      for ( ; rx < num; ++rx) {
+        const double *x = block + rx*used_f_num; 
+        int nx = root_nx; 
+        int fx; 
+        while ((fx = fx_gt[nx*2]) >= 0) {
+          nx = (x[fx] <= border[nx]) ? nx+1 : fx_gt[nx*2+1]; 
+        }
+        lf[rx] = nx; 
+      }
+    }
+
+    /*---  each model: its own leaf values in its own tree order  ---*/
+    for (mx = 0; mx < model_num; ++mx) {
+      const double *m_border = flat[mx]->border; 
+      double *p = pred[mx] + d0; 
+      for (rx = 0; rx < num; ++rx) p[rx] = flat[mx]->const_val; 
+      int tx; 
+      for (tx = tree_beg[mx]; tx < tree_beg[mx+1]; ++tx) {
+        const double *lf = leaf + tree_struct[tx]*rows; 
+        const double *val = m_border + tree_offs[tx]; 
+        for (rx = 0; rx < num; ++rx) {
+          p[rx] += val[(int)lf[rx]]; 
+        }
+      }
+    }
+  }
+  a_pred.free(&pred); 
+}
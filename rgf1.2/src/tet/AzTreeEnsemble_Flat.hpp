@@ -0,0 +1,225 @@
+/* * * * *
+ *  AzTreeEnsemble_Flat.hpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#ifndef _AZ_TREE_ENSEMBLE_FLAT_HPP_
+#define _AZ_TREE_ENSEMBLE_FLAT_HPP_
+
+#include "AzUtil.hpp"
+#include "AzSmat.hpp"
+#include "AzDmat.hpp"
+#include "AzTreeEnsemble.hpp"
+#include "AzTE_ModelInfo.hpp"
+#include "AzMappedFile.hpp"
+#include "AzStrPool.hpp"
+
+/*---  vector instructions for traversal; chosen at run time  ---*/
+enum AzFlatSimd {
+  AzFlatSimd_None = 0, 
+  AzFlatSimd_AVX2 = 1,   /* 8 rows at a time */
+  AzFlatSimd_AVX512 = 2, /* 16 rows at a time; AVX-512F and VL */
+}; 
+
+/*---  header of the flat model file (see write())  ---*/
+struct AzFlatModelHeader {
+  char magic[8]; 
+  char loss[16];     /* "loss=" in the configuration; may be empty */
+  int version; 
+  int marker;        /* to detect byte order mismatch */
+  int org_dim;       /* #feature of training data */
+  int org_f_num, used_f_num; 
+  int tree_num, root_num, node_num, leaf_num; 
+  int config_len, sign_len; 
+  int reserved; 
+  double const_val; 
+  AZint8 body_len;   /* bytes after the header */
+  AZint8 checksum;   /* of the bytes after the header */
+}; 
+
+//! Tree ensemble compiled for prediction only.
+/**
+  *  The nodes of all the trees are in contiguous arrays in depth-first order,
+  *  so that the "<=" child of an internal node is the next node.
+  *  Feature id and ">" child are next to each other so that one load
+  *  (or one gather) fetches both.
+  *  Each leaf keeps the sum of the weights on its path, added in the
+  *  same order as AzTree::apply, so predictions are exactly the same.
+  *  Feature ids are renumbered to the features used by the trees, and
+  *  data points are densified and scored a block of rows at a time.
+  *  Within a block, AVX2 or AVX-512 moves 8 or 16 rows down a tree
+  *  together if the CPU has it (gathered loads, compare masks), and the
+  *  rest of the rows go one at a time.  Blocks with mostly zero values go
+  *  one row at a time, as the branches are predictable there and the
+  *  scalar loop is faster.
+  *  The arrays can be saved as they are (write()) and used directly from
+  *  a memory-mapped file (read()), so loading takes no deserialization.
+ **/
+class AzTreeEnsemble_Flat {
+protected:
+  /*---  nodes (SoA); node# is global over the trees; made by reset()  ---*/
+  AzIntArr ia_fx_gt;   /* [nx*2]: compact feature id; -1 for a leaf */
+                       /* [nx*2+1]: node# for x[fx] > border_val; "<=" is nx+1 */
+  AzDvect v_border;    /* border_val, or path weight sum at a leaf */
+  AzIntArr ia_root;    /* root node# of each tree */
+  AzIntArr ia_org2fx;  /* original feature id -> compact id or -1 */
+
+  /*---  what apply() reads: the arrays above or a mapped file  ---*/
+  const int *fx_gt; 
+  const double *border; 
+  const int *root; 
+  const int *org2fx; 
+  int node_num, root_num; 
+
+  int used_f_num, org_f_num; 
+  double const_val; 
+  AzFlatSimd simd; 
+
+  /*---  model info  ---*/
+  int tree_num, leaf_num, org_dim; 
+  AzBytArr s_config, s_sign; 
+  AzMappedFile mfile; /* used by read() */
+
+  static const int block_size_max = 256; /* rows per block */
+  static const int block_elm_max = 32768; /* doubles per dense block */
+  static const int block_size_min = 16;  /* to use vector instructions */
+
+public:
+  AzTreeEnsemble_Flat() : fx_gt(NULL), border(NULL), root(NULL), org2fx(NULL), 
+                          node_num(0), root_num(0), 
+                          used_f_num(0), org_f_num(0), const_val(0), 
+                          simd(detect_simd()), 
+                          tree_num(0), leaf_num(0), org_dim(-1) {}
+  AzTreeEnsemble_Flat(const AzTreeEnsemble *ens)
+                        : fx_gt(NULL), border(NULL), root(NULL), org2fx(NULL), 
+                          node_num(0), root_num(0), 
+                          used_f_num(0), org_f_num(0), const_val(0), 
+                          simd(detect_simd()), 
+                          tree_num(0), leaf_num(0), org_dim(-1) {
+    reset(ens); 
+  }
+  void reset(const AzTreeEnsemble *ens); 
+
+  /*---  flat model file  ---*/
+  void write(const char *fn) const; 
+  void read(const char *fn); /* maps the file; no copy */
+  static bool isFlatModel(const char *fn); 
+  /*---  either format  ---*/
+  void reset(const char *model_fn) {
+    if (isFlatModel(model_fn)) {
+      read(model_fn); 
+    }
+    else {
+      AzTreeEnsemble ens(model_fn); 
+      reset(&ens); 
+    }
+  }
+
+  void apply(const AzSmat *m_data,
+             AzDvect *v_pred) /* output */
+             const; 
+
+  inline int treeNum() const { return root_num; } /* non-empty trees */
+  inline int nodeNum() const { return node_num; }
+  inline int orgdim() const { return org_dim; }
+  inline double constant() const { return const_val; }
+  void info(AzTE_ModelInfo *out_info) const; 
+
+  /*---  to use less than what the CPU has (e.g., for comparison)  ---*/
+  inline void set_simd(AzFlatSimd inp) {
+    simd = (AzFlatSimd)MIN((int)inp, (int)detect_simd()); 
+  }
+  inline AzFlatSimd simdType() const { return simd; }
+  static AzFlatSimd detect_simd(); 
+
+  /*---  prohibit =  ---*/
+  AzTreeEnsemble_Flat & operator =(const AzTreeEnsemble_Flat &inp) {
+    if (this == &inp) return *this; 
+    throw new AzException("AzTreeEnsemble_Flat =", "Don't use ="); 
+  }
+
+protected:
+  friend class AzTreeEnsemble_FlatBatch; 
+  void compile(const AzTree *tree, int nx, double path_sum); 
+  void release(); 
+  static AZint8 checksum(const AzByte *bytes, AZint8 len); 
+}; 
+
+//! Several tree ensembles applied to data in one pass.
+/**
+  *  Meant for the models saved at the checkpoints of one training run, 
+  *  which share most of their trees.  Trees are shared by structure 
+  *  (features, borders, shape), not by weights, since weights are 
+  *  re-optimized at every checkpoint.  Each distinct structure is 
+  *  traversed once per data point to find the leaf, and then each model 
+  *  adds its own value of the leaf, in its own tree order, so that the 
+  *  predictions are exactly the same as AzTreeEnsemble_Flat::apply. 
+ **/
+class AzTreeEnsemble_FlatBatch {
+protected:
+  AzObjPtrArray<AzTreeEnsemble_Flat> a_flat; 
+  AzTreeEnsemble_Flat **flat; 
+  int model_num; 
+
+  /*---  distinct tree structures; same layout as AzTreeEnsemble_Flat  ---*/
+  AzIntArr ia_fx_gt; 
+  AzDvect v_border;    /* border_val, or the node# itself at a leaf */
+  AzIntArr ia_root; 
+  AzIntArr ia_org2fx; 
+  int used_f_num, org_f_num; 
+  AzFlatSimd simd; 
+
+  /*---  trees of model#mx: [ia_tree_beg[mx], ia_tree_beg[mx+1])  ---*/
+  AzIntArr ia_tree_beg; 
+  AzIntArr ia_tree_struct; /* structure id */
+  AzIntArr ia_tree_offs;   /* model's node# minus structure's node# */
+
+  static const int block_size_max = 256; 
+  static const int block_elm_max = 32768; 
+  static const int block_size_min = 16; 
+  static const int leaf_elm_max = 1048576; /* leaf node# per block */
+
+public:
+  AzTreeEnsemble_FlatBatch() : flat(NULL), model_num(0), used_f_num(0), org_f_num(0), 
+                               simd(AzTreeEnsemble_Flat::detect_simd()) {}
+  ~AzTreeEnsemble_FlatBatch() {
+    a_flat.free(&flat); 
+  }
+  void reset(const AzStrPool *sp_model_fn); /* either format */
+  void apply(const AzSmat *m_data, 
+             AzDataArray<AzDvect> *av_pred) /* output: one per model */
+             const; 
+
+  inline int modelNum() const { return model_num; }
+  inline const AzTreeEnsemble_Flat *model(int mx) const {
+    if (mx < 0 || mx >= model_num) {
+      throw new AzException("AzTreeEnsemble_FlatBatch::model", "out of range"); 
+    }
+    return flat[mx]; 
+  }
+  inline int treeNum() const { return ia_tree_struct.size(); } /* non-empty trees of all */
+  inline int structNum() const { return ia_root.size(); }
+
+protected:
+  int walk(const AzTreeEnsemble_Flat *fl, int nx, 
+           const int *fx2org, 
+           AzBytArr *s_key) const; /* returns the next node# */
+
+  /*---  prohibit copying  ---*/
+  AzTreeEnsemble_FlatBatch(const AzTreeEnsemble_FlatBatch &); 
+  AzTreeEnsemble_FlatBatch & operator =(const AzTreeEnsemble_FlatBatch &); 
+}; 
+#endif
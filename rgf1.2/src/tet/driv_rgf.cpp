@@ -27,7 +27,7 @@
 void help(int argc, const char *argv[])
 {
   cout << "Arguments: action  parameters" <<endl; 
-  cout << "   action: "<<kw_train<<"|"<<kw_predict<<"|"<<kw_train_test<<"|"<<kw_train_predict<<"|"<<kw_features<<endl; 
+  cout << "   action: "<<kw_train<<"|"<<kw_predict<<"|"<<kw_train_test<<"|"<<kw_train_predict<<"|"<<kw_features<<"|"<<kw_convert<<"|"<<kw_serve<<endl; 
   AzHelp h(log_out); 
   h.set_indent(11); 
   h.set_kw_width(17); 
@@ -42,6 +42,10 @@ void help(int argc, const char *argv[])
   h.item_noquotes(s_kw.c_str(), s_desc.c_str()); 
   s_kw.reset(kw_features); s_kw.c(" ..."); s_desc.reset(help_features); 
   h.item_noquotes(s_kw.c_str(), s_desc.c_str()); 
+  s_kw.reset(kw_convert); s_kw.c("    ..."); s_desc.reset(help_convert); 
+  h.item_noquotes(s_kw.c_str(), s_desc.c_str()); 
+  s_kw.reset(kw_serve); s_kw.c("      ..."); s_desc.reset(help_serve); 
+  h.item_noquotes(s_kw.c_str(), s_desc.c_str()); 
   cout << endl; 
   cout << "To get help on parameters, enter "<<argv[0]<<" action."<<endl; 
   cout << "For example:  "<<argv[0]<<" "<<kw_train_test<<endl; 
@@ -86,6 +90,12 @@ int main(int argc, const char *argv[])
     else if (strcmp(action, kw_features) == 0) {
       driver.features(argv, argc); 
     }
+    else if (strcmp(action, kw_convert) == 0) {
+      driver.convert(argv, argc); 
+    }
+    else if (strcmp(action, kw_serve) == 0) {
+      driver.serve(argv, argc); 
+    }
     else {
       help(argc, argv); 
       return -1; 
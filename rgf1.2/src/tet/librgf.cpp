@@ -0,0 +1,331 @@
+/* * * * *
+ *  librgf.cpp
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#define _AZ_MAIN_
+#define _LIBRGF_BUILD_
+#include "AzUtil.hpp"
+#include "AzParam.hpp"
+#include "AzTETmain_kw.hpp"
+#include "AzRgfTrainerSel.hpp"
+#include "AzTreeEnsemble.hpp"
+#include "AzTreeEnsemble_Flat.hpp"
+#include "librgf.h"
+
+/*---  tree ensembles at the checkpoints  ---*/
+struct rgf_model {
+  AzObjPtrArray<AzTreeEnsemble> a_ens; 
+  AzTreeEnsemble **ens; 
+  int ens_num; 
+
+  rgf_model() : ens(NULL), ens_num(0) {}
+  ~rgf_model() {
+    a_ens.free(&ens); 
+  }
+  AzTreeEnsemble *new_ens() {
+    if (ens_num >= a_ens.size()) {
+      a_ens.realloc(&ens, MAX(ens_num*2, 16), "rgf_model::new_ens", "ens"); 
+    }
+    ens[ens_num] = new AzTreeEnsemble(); 
+    return ens[ens_num++]; 
+  }
+  const AzTreeEnsemble *point(int model_no) const {
+    int mx = (model_no < 0) ? ens_num-1 : model_no; 
+    if (mx < 0 || mx >= ens_num) {
+      AzBytArr s("model_no="); s.cn(model_no); s.c(" is out of range: the model has "); 
+      s.cn(ens_num); s.c(" tree ensemble(s)"); 
+      throw new AzException(AzInputError, "rgf_model::point", s.c_str()); 
+    }
+    return ens[mx]; 
+  }
+}; 
+
+/*---  error message of the last call in this thread  ---*/
+#if defined(_MSC_VER)
+#define RGF_THREAD_LOCAL __declspec(thread)
+#else
+#define RGF_THREAD_LOCAL thread_local
+#endif
+#define rgf_error_max 4096
+static RGF_THREAD_LOCAL char last_error[rgf_error_max]; 
+
+/*---  no log until rgf_set_log  ---*/
+static struct rgf_log_init {
+  rgf_log_init() { log_out.deactivate(); }
+} log_init; 
+
+/*------------------------------------------------------------------*/
+static void set_error(const char *msg)
+{
+  strncpy(last_error, msg, rgf_error_max-1); 
+  last_error[rgf_error_max-1] = '\0'; 
+}
+static void set_error(AzException *e)
+{
+  set_error(e->getMessage().c_str()); 
+  delete e; 
+}
+static void set_error_unknown()
+{
+  set_error("Unexpected error (e.g., out of memory)"); 
+}
+
+/*------------------------------------------------------------------*/
+static void prepare()
+{
+  Az_check_system_(); 
+  last_error[0] = '\0'; 
+}
+
+/*------------------------------------------------------------------*/
+/* Copy the data into AzSmat, one column per data point.  Zero values */
+/* are not stored, as when reading data files.                        */
+/*------------------------------------------------------------------*/
+static void to_smat(const rgf_data *x,
+                    AzSmat *m_x) /* output */
+{
+  const char *eyec = "librgf::to_smat"; 
+  if (x == NULL) {
+    throw new AzException(AzInputMissing, eyec, "No data"); 
+  }
+  if (x->row_num <= 0 || x->col_num <= 0) {
+    throw new AzException(AzInputNotValid, eyec, "row_num and col_num must be positive"); 
+  }
+  if (x->dense == NULL && (x->indptr == NULL || x->indices == NULL || x->values == NULL)) {
+    throw new AzException(AzInputMissing, eyec, "Either dense or indptr/indices/values is needed"); 
+  }
+  m_x->reform(x->col_num, x->row_num); 
+
+  AzIntArr ia_no; 
+  AzDvect v_val(x->col_num); 
+  ia_no.prepare(x->col_num); 
+  double *val = v_val.point_u(); 
+  int row; 
+  for (row = 0; row < x->row_num; ++row) {
+    ia_no.reset(); 
+    if (x->dense != NULL) {
+      const double *inp = x->dense + (AZint8)row*x->col_num; 
+      int col; 
+      for (col = 0; col < x->col_num; ++col) {
+        if (inp[col] != 0) {
+          val[ia_no.size()] = inp[col]; 
+          ia_no.put(col); 
+        }
+      }
+    }
+    else {
+      int beg = x->indptr[row], end = x->indptr[row+1]; 
+      if (beg < 0 || end < beg || end-beg > x->col_num) {
+        AzBytArr s("Invalid indptr at row#"); s.cn(row); 
+        throw new AzException(AzInputNotValid, eyec, s.c_str()); 
+      }
+      int ix; 
+      for (ix = beg; ix < end; ++ix) {
+        if (x->values[ix] != 0) {
+          val[ia_no.size()] = x->values[ix]; 
+          ia_no.put(x->indices[ix]); 
+        }
+      }
+    }
+    /* AzSvect::load checks the range and the order of feature ids */
+    m_x->col_u(row)->load(ia_no.point(), val, ia_no.size()); 
+  }
+}
+
+/*------------------------------------------------------------------*/
+int rgf_api_version()
+{
+  return RGF_API_VERSION; 
+}
+
+/*------------------------------------------------------------------*/
+const char *rgf_last_error()
+{
+  return last_error; 
+}
+
+/*------------------------------------------------------------------*/
+void rgf_set_log(int verbose)
+{
+  if      (verbose == 1) log_out.setStdout(); 
+  else if (verbose == 2) log_out.setStderr(); 
+  else                   log_out.deactivate(); 
+}
+
+/*------------------------------------------------------------------*/
+int rgf_train(const char *param,
+              const rgf_data *x,
+              const double *y,
+              const double *weights,
+              rgf_model **model)
+{
+  const char *eyec = "rgf_train"; 
+  rgf_model *mod = NULL; 
+  try {
+    prepare(); 
+    if (model == NULL || y == NULL) {
+      throw new AzException(AzInputMissing, eyec, "model and y are needed"); 
+    }
+    *model = NULL; 
+
+    /*---  parameters for us; the rest go to the trainer  ---*/
+    AzRgfTrainerSel alg_sel; 
+    AzBytArr s_alg_name(alg_sel.dflt_name()), s_tet_param; 
+    bool doSaveLastModelOnly = false; 
+    AzParam p((param == NULL) ? "" : param); 
+    p.vStr(kw_alg_name, &s_alg_name); 
+    p.swOn(&doSaveLastModelOnly, kw_doSaveLastModelOnly); 
+    p.check(log_out, &s_tet_param); 
+
+    AzSmat m_x; 
+    to_smat(x, &m_x); 
+    AzDvect v_y(y, x->row_num), v_dw; 
+    if (weights != NULL) {
+      v_dw.set(weights, x->row_num); 
+    }
+
+    AzTETrainer *trainer = alg_sel.select(s_alg_name.c_str()); 
+    trainer->rejectUnknownParam(true); /* no log to warn in by default */
+    mod = new rgf_model(); 
+    trainer->startup(log_out, s_tet_param.c_str(), &m_x, &v_y, NULL,
+                     (weights != NULL) ? &v_dw : NULL, NULL); 
+    for ( ; ; ) {
+      AzTETrainer_Ret ret = trainer->proceed_until(); 
+      if (!doSaveLastModelOnly || ret == AzTETrainer_Ret_Exit) {
+        trainer->copy_to(mod->new_ens()); 
+      }
+      if (ret == AzTETrainer_Ret_Exit) {
+        break; 
+      }
+    }
+    *model = mod; 
+  }
+  catch (AzException *e) {
+    set_error(e); 
+    delete mod; 
+    return -1; 
+  }
+  catch (...) {
+    set_error_unknown(); 
+    delete mod; 
+    return -1; 
+  }
+  return 0; 
+}
+
+/*------------------------------------------------------------------*/
+int rgf_model_num(const rgf_model *model)
+{
+  if (model == NULL) return 0; 
+  return model->ens_num; 
+}
+
+/*------------------------------------------------------------------*/
+int rgf_predict(const rgf_model *model,
+                int model_no,
+                const rgf_data *x,
+                double *pred)
+{
+  const char *eyec = "rgf_predict"; 
+  try {
+    prepare(); 
+    if (model == NULL || pred == NULL) {
+      throw new AzException(AzInputMissing, eyec, "model and pred are needed"); 
+    }
+    AzTreeEnsemble_Flat flat(model->point(model_no)); 
+    if (x != NULL && flat.orgdim() > 0 && flat.orgdim() != x->col_num) {
+      AzBytArr s("#feature in test data is "); s.cn(x->col_num); 
+      s.c(", whereas #feature in training data was "); s.cn(flat.orgdim()); 
+      throw new AzException(AzInputError, eyec, s.c_str()); 
+    }
+    AzSmat m_x; 
+    to_smat(x, &m_x); 
+    AzDvect v_p; 
+    flat.apply(&m_x, &v_p); 
+    memcpy(pred, v_p.point(), sizeof(double)*v_p.rowNum()); 
+  }
+  catch (AzException *e) {
+    set_error(e); 
+    return -1; 
+  }
+  catch (...) {
+    set_error_unknown(); 
+    return -1; 
+  }
+  return 0; 
+}
+
+/*------------------------------------------------------------------*/
+int rgf_save(const rgf_model *model, int model_no, const char *fn)
+{
+  const char *eyec = "rgf_save"; 
+  try {
+    prepare(); 
+    if (model == NULL || fn == NULL) {
+      throw new AzException(AzInputMissing, eyec, "model and fn are needed"); 
+    }
+    AzTreeEnsemble *ens = (AzTreeEnsemble *)model->point(model_no); /* write() doesn't change it */
+    ens->write(fn); 
+  }
+  catch (AzException *e) {
+    set_error(e); 
+    return -1; 
+  }
+  catch (...) {
+    set_error_unknown(); 
+    return -1; 
+  }
+  return 0; 
+}
+
+/*------------------------------------------------------------------*/
+int rgf_load(const char *fn,
+             rgf_model **model)
+{
+  const char *eyec = "rgf_load"; 
+  rgf_model *mod = NULL; 
+  try {
+    prepare(); 
+    if (model == NULL || fn == NULL) {
+      throw new AzException(AzInputMissing, eyec, "model and fn are needed"); 
+    }
+    *model = NULL; 
+    if (AzTreeEnsemble_Flat::isFlatModel(fn)) {
+      throw new AzException(AzInputError, eyec, "Flat model files can only be used by predict; use the original model file:", fn); 
+    }
+    mod = new rgf_model(); 
+    mod->new_ens()->read(fn); 
+    *model = mod; 
+  }
+  catch (AzException *e) {
+    set_error(e); 
+    delete mod; 
+    return -1; 
+  }
+  catch (...) {
+    set_error_unknown(); 
+    delete mod; 
+    return -1; 
+  }
+  return 0; 
+}
+
+/*------------------------------------------------------------------*/
+void rgf_free(rgf_model *model)
+{
+  delete model; 
+}
@@ -0,0 +1,100 @@
+/* * * * *
+ *  librgf.h
+ *  Copyright (C) 2011, 2012 Rie Johnson
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * * * * */
+
+#ifndef _LIBRGF_H_
+#define _LIBRGF_H_
+
+/*
+ *  C interface to RGF training and prediction, for calling RGF in-process
+ *  (e.g., from Python via ctypes) without data files.
+ *  Build the shared library with "make lib" (bin/librgf.so).
+ *
+ *  - Functions that can fail return 0 on success and -1 on failure;
+ *    rgf_last_error() then returns the message.
+ *  - Parameters are the same as the "train" action of the executable,
+ *    separated by commas, e.g., "reg_L2=1,loss=LS,max_leaf_forest=500".
+ *    algorithm= and SaveLastModelOnly are accepted as well.  Any other
+ *    parameter, including file names (train_x_fn= etc.), is an error.
+ *  - A model holds the tree ensembles saved at the checkpoints of training
+ *    (every test_interval= leaves, and at the end),
+ *    or only the last one with SaveLastModelOnly.
+ *  - Log messages are off by default; see rgf_set_log().
+ *  - Error messages are per thread.  The log setting is per process;
+ *    set it before other calls.  Otherwise, different models can be used
+ *    in different threads at the same time.
+ */
+
+#if defined(_WIN32) && defined(_LIBRGF_BUILD_)
+#define RGF_API __declspec(dllexport)
+#else
+#define RGF_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RGF_API_VERSION 1
+
+/*---  data points; one row per data point  ---*/
+typedef struct {
+  int row_num;            /* #data points */
+  int col_num;            /* #features */
+  /*---  dense: row_num x col_num, row-major; or NULL for CSR  ---*/
+  const double *dense; 
+  /*---  CSR: used if dense is NULL  ---*/
+  const int *indptr;      /* [row_num+1]: row r is [indptr[r], indptr[r+1]) */
+  const int *indices;     /* feature ids, in the ascending order in each row */
+  const double *values; 
+} rgf_data; 
+
+typedef struct rgf_model rgf_model; /* opaque */
+
+RGF_API int rgf_api_version(void); 
+RGF_API const char *rgf_last_error(void); 
+
+/*---  verbose=1: log to stdout, 2: to stderr, 0: no log (default)  ---*/
+RGF_API void rgf_set_log(int verbose); 
+
+/*---  y[row_num]; weights[row_num] or NULL  ---*/
+RGF_API int rgf_train(const char *param,
+                      const rgf_data *x,
+                      const double *y,
+                      const double *weights,
+                      rgf_model **model); /* output; release with rgf_free */
+
+RGF_API int rgf_model_num(const rgf_model *model); 
+
+/*---  model_no: 0,1,... in the order of checkpoints; -1 for the last one  ---*/
+RGF_API int rgf_predict(const rgf_model *model,
+                        int model_no,
+                        const rgf_data *x,
+                        double *pred); /* output: [x->row_num] */
+
+/*---  in the format of the executable's model files  ---*/
+RGF_API int rgf_save(const rgf_model *model, int model_no, const char *fn); 
+RGF_API int rgf_load(const char *fn,
+                     rgf_model **model); /* output; one ensemble */
+
+RGF_API void rgf_free(rgf_model *model); 
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif